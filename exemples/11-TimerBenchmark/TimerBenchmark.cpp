@@ -0,0 +1,68 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "SwCoreApplication.h"
+#include "SwTimer.h"
+
+// Nombre de timers armés en permanence pendant le benchmark
+static const int kTimerCount = 100000;
+
+static double elapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    SwCoreApplication app;
+
+    // 1) Coût d'armement : 100k timers lointains (10 à 20 secondes)
+    std::vector<int> timerIds;
+    timerIds.reserve(kTimerCount);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kTimerCount; ++i) {
+        int interval = 10000000 + (i % 1000) * 10000;
+        timerIds.push_back(app.addTimer([]() {}, interval));
+    }
+    double armUs = elapsedUs(start);
+    std::cout << "[Bench] addTimer    : " << (armUs * 1000.0 / kTimerCount) << " ns/timer" << std::endl;
+
+    // 2) Surcoût de la boucle : une sonde à 1 ms pendant que les 100k timers restent armés
+    long long probeTicks = 0;
+    double maxLatenessUs = 0;
+    auto lastTick = std::chrono::steady_clock::now();
+    int probeId = app.addTimer([&]() {
+        double lateness = elapsedUs(lastTick) - 1000.0;
+        if (probeTicks > 0 && lateness > maxLatenessUs) {
+            maxLatenessUs = lateness;
+        }
+        lastTick = std::chrono::steady_clock::now();
+        ++probeTicks;
+    }, 1000);
+
+    start = std::chrono::steady_clock::now();
+    app.exec(1000000); // une seconde de boucle
+    double loopUs = elapsedUs(start);
+    app.removeTimer(probeId);
+    std::cout << "[Bench] loop        : " << probeTicks << " ticks of 1 ms in " << loopUs / 1000.0
+              << " ms, max lateness " << maxLatenessUs << " us" << std::endl;
+
+    // 3) Coût d'arrêt : retrait de tous les timers
+    start = std::chrono::steady_clock::now();
+    for (int id : timerIds) {
+        app.removeTimer(id);
+    }
+    double removeUs = elapsedUs(start);
+    std::cout << "[Bench] removeTimer : " << (removeUs * 1000.0 / kTimerCount) << " ns/timer" << std::endl;
+
+    // 4) Cycle start/stop d'un SwTimer, typique d'un timeout réarmé à chaque message
+    SwTimer timer;
+    timer.setInterval(5000);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kTimerCount; ++i) {
+        timer.start();
+        timer.stop();
+    }
+    double cycleUs = elapsedUs(start);
+    std::cout << "[Bench] SwTimer start/stop : " << (cycleUs * 1000.0 / kTimerCount) << " ns/cycle" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include <iostream>
+#include <atomic>
+#include "SwCoreApplication.h"
+#include "SwShardedRuntime.h"
+#include "SwEventLoop.h"
+#include "SwTimer.h"
+
+// Nombre de tâches réparties sur les boucles
+static const int kTaskCount = 100000;
+
+int main() {
+    SwCoreApplication app;
+
+    // Une boucle par cœur, chaque thread épinglé sur son CPU
+    SwShardedRuntime runtime(0, true);
+    runtime.start();
+    std::cout << "[Main] " << runtime.loopCount() << " event loops started" << std::endl;
+
+    // Chaque boucle a ses propres timers : on en démarre un par boucle
+    for (int i = 0; i < runtime.loopCount(); ++i) {
+        runtime.postTo(i, []() {
+            SwTimer* heartbeat = new SwTimer(500);
+            SwObject::connect(heartbeat, SIGNAL(timeout), []() {
+                std::cout << "[Loop " << SwShardedRuntime::currentIndex() << "] heartbeat" << std::endl;
+            });
+            heartbeat->start();
+        });
+    }
+
+    // Répartition round-robin ; le résultat revient sur la boucle principale
+    std::atomic<int> remaining(kTaskCount);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kTaskCount; ++i) {
+        runtime.post([&app, &remaining, start]() {
+            if (--remaining == 0) {
+                app.postEvent([start]() {
+                    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+                    std::cout << "[Main] " << kTaskCount << " tasks done in " << elapsed << " ms" << std::endl;
+                });
+            }
+        }, ExecutionHint::Inline);
+    }
+
+    // Une tâche qui cède la main reste sur la boucle qui l'a démarrée
+    runtime.postTo(0, []() {
+        SwEventLoop::swsleep(200);
+        std::cout << "[Loop " << SwShardedRuntime::currentIndex() << "] resumed after swsleep" << std::endl;
+    });
+
+    SwTimer::singleShot(2000, [&app]() {
+        app.quit();
+    });
+    int code = app.exec();
+    runtime.stop();
+    return code;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <thread>
+#include "SwCoreApplication.h"
+#include "SwTimer.h"
+#include "SwFuture.h"
+#include "SwTask.h"
+
+// Nombre de coroutines en vol simultanément
+static const int kTaskCount = 100000;
+
+class Sensor : public SwObject {
+public:
+    DECLARE_SIGNAL(measured)
+};
+
+// Calcul lent sur un autre thread, résultat livré par une future
+SwFuture<int> computeAsync(int value) {
+    SwPromise<int> promise;
+    SwFuture<int> future = promise.future();
+    std::thread([promise, value]() mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        promise.setValue(value * value);
+    }).detach();
+    return future;
+}
+
+SwTask<int> tick(int delayMs, int value) {
+    co_await SwCoroutines::delay(delayMs);
+    co_return value;
+}
+
+SwTask<> demo(Sensor* sensor) {
+    int square = co_await computeAsync(12);
+    std::cout << "[Task] computed on a thread: " << square << std::endl;
+
+    SwTimer::singleShot(50, [sensor]() {
+        sensor->measured(21.5);
+    });
+    double measure = co_await SwCoroutines::signal<double>(sensor, SIGNAL(measured));
+    std::cout << "[Task] signal received: " << measure << std::endl;
+
+    // Un cadre de coroutine de quelques centaines d'octets au lieu d'une pile de fibre
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SwTask<int>> tasks;
+    tasks.reserve(kTaskCount);
+    for (int i = 0; i < kTaskCount; ++i) {
+        tasks.push_back(tick(10 + i % 100, 1));
+        tasks.back().start();
+    }
+    long long sum = 0;
+    for (SwTask<int>& task : tasks) {
+        sum += co_await task;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    SwCoroutineFrameAllocator::Stats stats = SwCoroutineFrameAllocator::stats();
+    std::cout << "[Task] " << sum << " coroutines in flight, done in " << elapsed << " ms ("
+              << stats.allocated << " frames allocated, " << stats.reused << " reused)" << std::endl;
+
+    SwCoreApplication::instance()->quit();
+}
+
+int main() {
+    SwCoreApplication app;
+    Sensor sensor;
+    demo(&sensor).detach();
+    return app.exec();
+}
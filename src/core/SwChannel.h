@@ -0,0 +1,475 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SwCoreApplication.h"
+#include "SwFiberWaiter.h"
+
+
+/**
+ * @brief Outcome of a non-blocking channel operation.
+ */
+enum class SwChannelStatus {
+    Done,       ///< The value was sent or received.
+    WouldBlock, ///< The channel is full (send) or empty (receive).
+    Closed      ///< The channel is closed (and, for a receive, drained).
+};
+
+
+/**
+ * @class SwChannel
+ * @brief Bounded multi-producer multi-consumer channel of values between fibers and threads.
+ *
+ * Values are stored in a ring buffer of `capacity()` slots allocated once, so sending a value
+ * costs a move and no allocation. When the channel is full, `send` parks the calling fiber (only
+ * that fiber: its event loop or `SwFiberScheduler` worker keeps running) until a receiver makes
+ * room; when it is empty, `receive` parks until a value arrives. Called from a plain thread, they
+ * block the thread. Waiters are resumed in arrival order.
+ *
+ * ### Closing:
+ * After `close()`, `send` fails and every parked sender or receiver is resumed. Receivers still
+ * get the values already queued; `receive` returns `false` once the channel is closed and empty.
+ *
+ * ### Example:
+ * ```cpp
+ * SwChannel<Record> parsed(256);
+ * SwChannel<SwString> lines(256);
+ *
+ * app.postEvent([&]() { // parse
+ *     SwString line;
+ *     while (lines.receive(line)) {
+ *         parsed.send(parse(line)); // parks this fiber while the writer lags behind
+ *     }
+ *     parsed.close();
+ * });
+ * ```
+ *
+ * `SwChannelSelect` waits on several channels at once.
+ *
+ * @warning A plain thread blocked on a channel whose other end is a fiber of the same thread
+ *          deadlocks; use `trySend` / `tryReceive` there.
+ */
+template<typename T>
+class SwChannel {
+public:
+    explicit SwChannel(size_t capacity = 1)
+        : m_capacity(capacity > 0 ? capacity : 1),
+          m_slots(new Slot[m_capacity]),
+          m_head(0),
+          m_count(0),
+          m_closed(false)
+    {}
+
+    ~SwChannel() {
+        while (m_count > 0) {
+            item(m_head)->~T();
+            m_head = (m_head + 1) % m_capacity;
+            --m_count;
+        }
+    }
+
+    SwChannel(const SwChannel&) = delete;
+    SwChannel& operator=(const SwChannel&) = delete;
+
+    /**
+     * @brief Sends `value`, waiting for room if the channel is full.
+     * @return `false` if the channel is closed; the value is then dropped.
+     */
+    template<typename U>
+    bool send(U&& value) {
+        SwFiberWaiter waiter;
+        SwFiberWaitNode node;
+        node.waiter = &waiter;
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_closed) {
+                    return false;
+                }
+                if (m_count < m_capacity) {
+                    pushLocked(std::forward<U>(value));
+                    return true;
+                }
+                waiter.prepare();
+                m_senders.push(&node);
+            }
+            waiter.wait();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_senders.remove(&node);
+        }
+    }
+
+    /**
+     * @brief Sends `value` only if there is room right away.
+     */
+    template<typename U>
+    SwChannelStatus trySend(U&& value) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closed) {
+            return SwChannelStatus::Closed;
+        }
+        if (m_count == m_capacity) {
+            return SwChannelStatus::WouldBlock;
+        }
+        pushLocked(std::forward<U>(value));
+        return SwChannelStatus::Done;
+    }
+
+    /**
+     * @brief Receives a value into `value`, waiting for one if the channel is empty.
+     * @return `false` if the channel is closed and empty.
+     */
+    bool receive(T& value) {
+        SwFiberWaiter waiter;
+        SwFiberWaitNode node;
+        node.waiter = &waiter;
+        while (true) {
+            SwChannelStatus status = tryReceiveWith([&value](T&& received) {
+                value = std::move(received);
+            }, &node);
+            if (status != SwChannelStatus::WouldBlock) {
+                return status == SwChannelStatus::Done;
+            }
+            waiter.wait();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_receivers.remove(&node);
+        }
+    }
+
+    /**
+     * @brief Receives a value only if one is queued.
+     */
+    SwChannelStatus tryReceive(T& value) {
+        return tryReceiveWith([&value](T&& received) {
+            value = std::move(received);
+        }, nullptr);
+    }
+
+    /**
+     * @brief Closes the channel and resumes every waiter. Queued values can still be received.
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_senders.wakeAll();
+        m_receivers.wakeAll();
+    }
+
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_closed;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_count;
+    }
+
+    size_t capacity() const {
+        return m_capacity;
+    }
+
+private:
+    friend class SwChannelSelect;
+
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+
+    T* item(size_t index) {
+        return reinterpret_cast<T*>(&m_slots[index]);
+    }
+
+    template<typename U>
+    void pushLocked(U&& value) {
+        new (&m_slots[(m_head + m_count) % m_capacity]) T(std::forward<U>(value));
+        ++m_count;
+        m_receivers.wakeOne();
+    }
+
+    /**
+     * @brief Pops a value and hands it to `consume` outside the lock. If the channel is empty and
+     *        `node` is given, enrolls it as a receiver before releasing the lock.
+     */
+    template<typename F>
+    SwChannelStatus tryReceiveWith(F&& consume, SwFiberWaitNode* node) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_count == 0) {
+            if (m_closed) {
+                return SwChannelStatus::Closed;
+            }
+            if (node) {
+                node->waiter->prepare();
+                m_receivers.push(node);
+            }
+            return SwChannelStatus::WouldBlock;
+        }
+        T* front = item(m_head);
+        T received(std::move(*front));
+        front->~T();
+        m_head = (m_head + 1) % m_capacity;
+        --m_count;
+        m_senders.wakeOne();
+        lock.unlock();
+        consume(std::move(received));
+        return SwChannelStatus::Done;
+    }
+
+    /**
+     * @brief Enrolls a select waiting to receive. Returns `false` if a value is already queued.
+     */
+    bool enrollReceiver(SwFiberWaitNode* node) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_count > 0) {
+            return false;
+        }
+        if (!m_closed) {
+            m_receivers.push(node);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Enrolls a select waiting to send. Returns `false` if there is room already.
+     */
+    bool enrollSender(SwFiberWaitNode* node) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closed) {
+            return true;
+        }
+        if (m_count < m_capacity) {
+            return false;
+        }
+        m_senders.push(node);
+        return true;
+    }
+
+    void withdraw(SwFiberWaitNode* node) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_receivers.remove(node);
+        m_senders.remove(node);
+    }
+
+    /**
+     * @brief Wakes the next waiters when a select woken by this channel served another one.
+     */
+    void passOn() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_count > 0) {
+            m_receivers.wakeOne();
+        }
+        if (m_count < m_capacity && !m_closed) {
+            m_senders.wakeOne();
+        }
+    }
+
+    const size_t m_capacity; ///< Number of slots.
+    std::unique_ptr<Slot[]> m_slots; ///< Ring buffer, values constructed in place.
+    size_t m_head; ///< Slot of the oldest value.
+    size_t m_count; ///< Number of queued values.
+    bool m_closed; ///< Set by `close()`.
+    mutable std::mutex m_mutex; ///< Protects the ring buffer and the wait lists.
+    SwFiberWaitList m_senders; ///< Waiting for room.
+    SwFiberWaitList m_receivers; ///< Waiting for a value.
+};
+
+
+/**
+ * @class SwChannelSelect
+ * @brief Waits until one of several channel operations can proceed, and performs only that one.
+ *
+ * Each case is a receive (`onReceive`, the handler gets the value) or a send (`onSend`, the value
+ * is given up front). `wait()` parks the fiber (or blocks the thread) until a case is ready,
+ * runs it and returns its index; ready cases are tried in rotating order so none starves.
+ * Cases on closed channels are skipped; when every channel is closed, `wait()` returns `-1`.
+ *
+ * ### Example:
+ * ```cpp
+ * SwChannelSelect select;
+ * select.onReceive(orders, [](Order order) { process(order); })
+ *       .onReceive(control, [&](Command command) { apply(command); });
+ * while (select.wait() >= 0) {
+ * }
+ * ```
+ *
+ * A select keeps its cases and can be waited on repeatedly; send cases resend the same value.
+ */
+class SwChannelSelect {
+public:
+    template<typename T, typename F>
+    SwChannelSelect& onReceive(SwChannel<T>& channel, F handler) {
+        m_cases.push_back(std::unique_ptr<Case>(new ReceiveCase<T, F>(channel, std::move(handler))));
+        m_nodes.resize(m_cases.size());
+        return *this;
+    }
+
+    template<typename T, typename F>
+    SwChannelSelect& onSend(SwChannel<T>& channel, T value, F handler) {
+        m_cases.push_back(std::unique_ptr<Case>(new SendCase<T, F>(channel, std::move(value), std::move(handler))));
+        m_nodes.resize(m_cases.size());
+        return *this;
+    }
+
+    /**
+     * @brief Runs the first case that can proceed without waiting.
+     * @return Its index, or `-1` if none can.
+     */
+    int tryWait() {
+        int closed = 0;
+        return attemptAll(closed);
+    }
+
+    /**
+     * @brief Waits for a case to be ready and runs it.
+     * @return The index of the case, or `-1` if every channel is closed.
+     */
+    int wait() {
+        const size_t count = m_cases.size();
+        SwFiberWaiter waiter;
+        bool woken = false;
+        while (true) {
+            int closed = 0;
+            int index = attemptAll(closed);
+            if (index >= 0) {
+                if (woken) {
+                    // Réveillé par un canal mais servi par un autre : on passe le relais
+                    for (size_t i = 0; i < count; ++i) {
+                        if (static_cast<int>(i) != index) {
+                            m_cases[i]->passOn();
+                        }
+                    }
+                }
+                return index;
+            }
+            if (closed == static_cast<int>(count)) {
+                return -1;
+            }
+
+            waiter.prepare();
+            bool ready = false;
+            for (size_t i = 0; i < count && !ready; ++i) {
+                m_nodes[i].waiter = &waiter;
+                ready = !m_cases[i]->enroll(&m_nodes[i]);
+            }
+            if (ready) {
+                waiter.wake(); // une opération est devenue possible pendant l'inscription
+            }
+            waiter.wait();
+            for (size_t i = 0; i < count; ++i) {
+                m_cases[i]->withdraw(&m_nodes[i]);
+            }
+            woken = true;
+        }
+    }
+
+private:
+    struct Case {
+        virtual ~Case() {}
+        virtual SwChannelStatus attempt() = 0;
+        virtual bool enroll(SwFiberWaitNode* node) = 0;
+        virtual void withdraw(SwFiberWaitNode* node) = 0;
+        virtual void passOn() = 0;
+    };
+
+    template<typename T, typename F>
+    struct ReceiveCase : Case {
+        ReceiveCase(SwChannel<T>& channel, F handler)
+            : channel(channel), handler(std::move(handler))
+        {}
+
+        SwChannelStatus attempt() override {
+            return channel.tryReceiveWith([this](T&& value) {
+                handler(std::move(value));
+            }, nullptr);
+        }
+
+        bool enroll(SwFiberWaitNode* node) override {
+            return channel.enrollReceiver(node);
+        }
+
+        void withdraw(SwFiberWaitNode* node) override {
+            channel.withdraw(node);
+        }
+
+        void passOn() override {
+            channel.passOn();
+        }
+
+        SwChannel<T>& channel;
+        F handler;
+    };
+
+    template<typename T, typename F>
+    struct SendCase : Case {
+        SendCase(SwChannel<T>& channel, T value, F handler)
+            : channel(channel), value(std::move(value)), handler(std::move(handler))
+        {}
+
+        SwChannelStatus attempt() override {
+            SwChannelStatus status = channel.trySend(static_cast<const T&>(value));
+            if (status == SwChannelStatus::Done) {
+                handler();
+            }
+            return status;
+        }
+
+        bool enroll(SwFiberWaitNode* node) override {
+            return channel.enrollSender(node);
+        }
+
+        void withdraw(SwFiberWaitNode* node) override {
+            channel.withdraw(node);
+        }
+
+        void passOn() override {
+            channel.passOn();
+        }
+
+        SwChannel<T>& channel;
+        T value;
+        F handler;
+    };
+
+    int attemptAll(int& closed) {
+        const size_t count = m_cases.size();
+        for (size_t k = 0; k < count; ++k) {
+            size_t i = (m_start + k) % count;
+            SwChannelStatus status = m_cases[i]->attempt();
+            if (status == SwChannelStatus::Done) {
+                m_start = (i + 1) % count;
+                return static_cast<int>(i);
+            }
+            if (status == SwChannelStatus::Closed) {
+                ++closed;
+            }
+        }
+        return -1;
+    }
+
+    std::vector<std::unique_ptr<Case>> m_cases; ///< Operations waited on.
+    std::vector<SwFiberWaitNode> m_nodes; ///< One wait-list entry per case.
+    size_t m_start = 0; ///< First case tried by the next attempt.
+};
@@ -0,0 +1,148 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+
+/**
+ * @class SwClock
+ * @brief Time source of the event loops: timer deadlines, fiber sleeps and `SwTimer::remainingTime()`.
+ *
+ * Each event loop has its own clock (see `SwCoreApplication::setClock`), the steady clock by
+ * default. `SwClock::now()` returns the time of the loop of the calling thread, and the steady
+ * time outside any loop.
+ *
+ * Only scheduling reads this clock, including the periods of the runtime budgets. Measurements
+ * of real work (load, drain budgets, the slices charged to runtimes, telemetry durations, the
+ * blocking-fiber watchdog) keep using the steady clock.
+ *
+ * ### Simulated time:
+ * A clock reporting `isSimulated()` is advanced by the loop itself: when a loop has nothing to
+ * run, instead of sleeping until its next deadline it calls `advanceTo(deadline)` and goes on at
+ * once. Timers fire in the same order as with the real clock, each one exactly at its deadline,
+ * while the run takes only the CPU time of the callbacks. See `SwSimulatedClock`.
+ */
+class SwClock {
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    virtual ~SwClock() = default;
+
+    /**
+     * @brief Current time of this clock.
+     */
+    virtual TimePoint currentTime() const = 0;
+
+    /**
+     * @brief `true` if the loops must advance the clock instead of waiting for it.
+     */
+    virtual bool isSimulated() const {
+        return false;
+    }
+
+    /**
+     * @brief Moves a simulated clock forward to `deadline` (never backward). No-op for a real clock.
+     */
+    virtual void advanceTo(TimePoint deadline) {
+        (void)deadline;
+    }
+
+    /**
+     * @brief Time of the clock of the calling thread's loop, or of `std::chrono::steady_clock`.
+     *
+     * Defined in SwCoreApplication.h, which resolves the loop through `currentLoop()`.
+     */
+    static TimePoint now();
+
+    /**
+     * @brief Returns the clock of the calling thread's loop, `nullptr` for the steady clock.
+     */
+    static SwClock* current();
+
+    /**
+     * @brief Time of `clock`, or of `std::chrono::steady_clock` when it is `nullptr`.
+     */
+    static TimePoint now(const SwClock* clock) {
+        return clock ? clock->currentTime() : std::chrono::steady_clock::now();
+    }
+};
+
+
+/**
+ * @class SwSimulatedClock
+ * @brief Virtual time that only moves when the event loop is idle (or when told to).
+ *
+ * Starts at the current steady time, so deadlines computed before the switch stay meaningful.
+ * Time does not pass while callbacks run: the loop jumps from one deadline to the next.
+ *
+ * ### Example:
+ * ```cpp
+ * SwSimulatedClock clock;
+ * app.setClock(&clock);
+ * // an hour of reconnect / backoff timers runs in a few milliseconds
+ * SwTimer::singleShot(3600 * 1000, [&]() { app.quit(); });
+ * app.exec();
+ * ```
+ *
+ * @note Work running outside the loop (a `SwThreadPool` job, another thread) takes no virtual
+ *       time: the loop may jump past its timers before that work completes. Several loops
+ *       (`SwShardedRuntime`) can share one clock by each calling `setClock` with it; an idle
+ *       loop then advances it for all of them.
+ */
+class SwSimulatedClock : public SwClock {
+public:
+    explicit SwSimulatedClock(TimePoint start = std::chrono::steady_clock::now())
+        : m_ticks(start.time_since_epoch().count())
+    {}
+
+    TimePoint currentTime() const override {
+        return TimePoint(TimePoint::duration(m_ticks.load(std::memory_order_acquire)));
+    }
+
+    bool isSimulated() const override {
+        return true;
+    }
+
+    void advanceTo(TimePoint deadline) override {
+        int64_t target = static_cast<int64_t>(deadline.time_since_epoch().count());
+        int64_t ticks = m_ticks.load(std::memory_order_relaxed);
+        while (ticks < target && !m_ticks.compare_exchange_weak(ticks, target, std::memory_order_acq_rel)) {
+        }
+    }
+
+    /**
+     * @brief Moves the clock forward by `duration`.
+     */
+    template<typename Rep, typename Period>
+    void advanceBy(std::chrono::duration<Rep, Period> duration) {
+        m_ticks.fetch_add(static_cast<int64_t>(std::chrono::duration_cast<TimePoint::duration>(duration).count()),
+                          std::memory_order_acq_rel);
+    }
+
+private:
+    std::atomic<int64_t> m_ticks; ///< `steady_clock` ticks since its epoch.
+};
+
+// SwClock::now() et SwClock::current() sont définies avec la boucle qu'elles interrogent
+#include "SwCoreApplication.h"
@@ -0,0 +1,440 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SwCoreApplication.h"
+#include "SwFuture.h"
+#include "SwList.h"
+#include "SwMap.h"
+#include "SwThreadPool.h"
+
+
+/**
+ * @class SwConcurrent
+ * @brief Runs functions on a `SwThreadPool` and returns their result as a `SwFuture`.
+ *
+ * The function runs on a pool thread, so blocking calls (file hashing, `SwFile::copyByChunk`,
+ * name resolution, large JSON documents) no longer stall the fibers of the event loop. When
+ * `run` is called from an event loop, the result is delivered back to that loop with
+ * `postEvent`: the future completes, and its `then()` continuations run, on the loop thread.
+ * From any other thread the future completes on the pool thread.
+ *
+ * ### Example:
+ * ```cpp
+ * SwFuture<SwString> checksum = SwConcurrent::run([path]() {
+ *     return SwFile(path).fileChecksum();
+ * });
+ * checksum.then([](SwString sum) {
+ *     // back on the event loop
+ * });
+ * SwString value = SwConcurrent::run(parseHugeDocument).await(); // parks only this fiber
+ * ```
+ *
+ * If the pool queue is full, the future fails right away with `std::runtime_error`.
+ *
+ * ### Parallel algorithms:
+ * `mapped`, `filtered`, `reduced` and `sort` process a `SwList` (and `mapped` / `filtered` /
+ * `reduced` the values of a `SwMap`) on the pool. The calling thread takes part in the work and
+ * returns once it is complete; wrap the call in `run()` to keep an event loop responsive.
+ * Elements are handed out in chunks whose size adapts to the measured cost of an element, so
+ * cheap elements are processed in large batches and expensive ones stay balanced across threads.
+ *
+ * ```cpp
+ * SwList<Record> records = load();
+ * SwList<SwString> names = SwConcurrent::mapped(records, [](const Record& r) { return r.name; });
+ * SwList<Record> adults = SwConcurrent::filtered(records, [](const Record& r) { return r.age >= 18; });
+ * long long total = SwConcurrent::reduced(records, 0LL,
+ *     [](long long& sum, const Record& r) { sum += r.amount; },
+ *     [](long long& sum, long long partial) { sum += partial; });
+ * SwConcurrent::sort(records, [](const Record& a, const Record& b) { return a.id < b.id; });
+ * ```
+ */
+class SwConcurrent {
+public:
+    /**
+     * @brief Runs `function` on the global thread pool.
+     */
+    template<typename F>
+    static SwFuture<decltype(std::declval<F&>()())> run(F function) {
+        return run(SwThreadPool::globalInstance(), std::move(function));
+    }
+
+    /**
+     * @brief Runs `function` on `pool`.
+     */
+    template<typename F>
+    static SwFuture<decltype(std::declval<F&>()())> run(SwThreadPool* pool, F function) {
+        typedef decltype(std::declval<F&>()()) R;
+        SwPromise<R> promise;
+        SwFuture<R> future = promise.future();
+        SwCoreApplication* loop = SwCoreApplication::currentLoop();
+        bool accepted = pool->tryStart([promise, function, loop]() mutable {
+            if (!loop) {
+                compute(promise, function, std::is_void<R>());
+                return;
+            }
+            // Le résultat est calculé ici puis livré sur la boucle appelante
+            std::shared_ptr<SwFutureState<R>> result = std::make_shared<SwFutureState<R>>();
+            compute(*result, function, std::is_void<R>());
+            loop->postEventUnbounded([promise, result]() mutable {
+                deliver(promise, *result);
+            });
+        });
+        if (!accepted) {
+            promise.setException(std::make_exception_ptr(std::runtime_error("SwConcurrent: thread pool queue is full")));
+        }
+        return future;
+    }
+
+    /**
+     * @brief Calls `body(begin, end)` over `[0, count)` split in chunks run on `pool`.
+     *
+     * With `grain == 0` the chunk size adapts: it starts at one element and is rescaled after
+     * each chunk so that a chunk lasts about `TargetChunkUs`, while leaving a few chunks per
+     * thread for balance. The calling thread runs chunks too. The first exception thrown by
+     * `body` stops the distribution and is rethrown here.
+     */
+    template<typename Body>
+    static void parallelFor(size_t count, Body body, size_t grain = 0, SwThreadPool* pool = SwThreadPool::globalInstance()) {
+        if (count == 0) {
+            return;
+        }
+        int participants = static_cast<int>((std::min)(static_cast<size_t>(pool->maxThreadCount()), count));
+        std::shared_ptr<ParallelRun> run = std::make_shared<ParallelRun>();
+        run->count = count;
+        run->body = [&body](size_t begin, size_t end) { body(begin, end); };
+        run->maxGrain = (std::max)(static_cast<size_t>(1), count / (static_cast<size_t>(participants) * ChunksPerThread));
+        run->adaptive = grain == 0;
+        run->grain.store(grain == 0 ? 1 : grain, std::memory_order_relaxed);
+        for (int i = 1; i < participants; ++i) {
+            if (!pool->tryStart([run]() { runChunks(*run); })) {
+                break; // file pleine : l'appelant et les threads déjà lancés font le reste
+            }
+        }
+        runChunks(*run);
+
+        std::unique_lock<std::mutex> lock(run->mutex);
+        run->finished.wait(lock, [&run]() { return run->isComplete(); });
+        if (run->exception) {
+            std::rethrow_exception(run->exception);
+        }
+    }
+
+    /**
+     * @brief Returns the list of `function(item)` for each item, in order.
+     *
+     * The result type must be default-constructible.
+     */
+    template<typename T, typename F>
+    static SwList<typename std::decay<decltype(std::declval<F&>()(std::declval<const T&>()))>::type>
+    mapped(const SwList<T>& list, F function) {
+        typedef typename std::decay<decltype(std::declval<F&>()(std::declval<const T&>()))>::type U;
+        std::unique_ptr<U[]> results(new U[list.size()]); // pas de std::vector<bool> partagé entre threads
+        const T* items = list.data();
+        parallelFor(list.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                results[i] = function(items[i]);
+            }
+        });
+        return SwList<U>(std::make_move_iterator(results.get()), std::make_move_iterator(results.get() + list.size()));
+    }
+
+    /**
+     * @brief Returns a map with the same keys and `function(value)` as values.
+     */
+    template<typename K, typename V, typename F>
+    static SwMap<K, typename std::decay<decltype(std::declval<F&>()(std::declval<const V&>()))>::type>
+    mapped(const SwMap<K, V>& map, F function) {
+        typedef typename std::decay<decltype(std::declval<F&>()(std::declval<const V&>()))>::type U;
+        std::vector<const std::pair<const K, V>*> entries = entriesOf(map);
+        std::unique_ptr<U[]> values(new U[entries.size()]);
+        parallelFor(entries.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                values[i] = function(entries[i]->second);
+            }
+        });
+        std::vector<std::pair<K, U>> pairs;
+        pairs.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            pairs.push_back(std::pair<K, U>(entries[i]->first, std::move(values[i])));
+        }
+        return SwMap<K, U>(std::make_move_iterator(pairs.begin()), std::make_move_iterator(pairs.end()));
+    }
+
+    /**
+     * @brief Returns the items for which `predicate(item)` is `true`, in order.
+     */
+    template<typename T, typename F>
+    static SwList<T> filtered(const SwList<T>& list, F predicate) {
+        std::vector<char> keep(list.size());
+        const T* items = list.data();
+        parallelFor(list.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                keep[i] = predicate(items[i]) ? 1 : 0;
+            }
+        });
+        SwList<T> result;
+        result.reserve(static_cast<size_t>(std::count(keep.begin(), keep.end(), 1)));
+        for (size_t i = 0; i < keep.size(); ++i) {
+            if (keep[i]) {
+                result.append(items[i]);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns the entries whose value satisfies `predicate(value)`.
+     */
+    template<typename K, typename V, typename F>
+    static SwMap<K, V> filtered(const SwMap<K, V>& map, F predicate) {
+        std::vector<const std::pair<const K, V>*> entries = entriesOf(map);
+        std::vector<char> keep(entries.size());
+        parallelFor(entries.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                keep[i] = predicate(entries[i]->second) ? 1 : 0;
+            }
+        });
+        std::vector<std::pair<K, V>> pairs;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (keep[i]) {
+                pairs.push_back(*entries[i]);
+            }
+        }
+        return SwMap<K, V>(pairs.begin(), pairs.end());
+    }
+
+    /**
+     * @brief Folds the items into a value.
+     *
+     * Each chunk starts from `identity` and accumulates its items with `reduce(accumulator, item)`;
+     * the partial results are then folded in list order with `combine(accumulator, partial)`. The
+     * operation must be associative; it does not need to be commutative.
+     */
+    template<typename T, typename R, typename Reduce, typename Combine>
+    static R reduced(const SwList<T>& list, R identity, Reduce reduce, Combine combine) {
+        return reduceItems(list.size(), [&list](size_t i) -> const T& { return list[i]; }, std::move(identity), reduce, combine);
+    }
+
+    /**
+     * @brief Folds the items with `reduce`, also used to combine partial results (`R` and `T`
+     *        being the same kind of value, e.g. a sum).
+     */
+    template<typename T, typename R, typename Reduce>
+    static R reduced(const SwList<T>& list, R identity, Reduce reduce) {
+        return reduced(list, std::move(identity), reduce, reduce);
+    }
+
+    /**
+     * @brief Folds the values of `map`, in key order (see the `SwList` overload).
+     */
+    template<typename K, typename V, typename R, typename Reduce, typename Combine>
+    static R reduced(const SwMap<K, V>& map, R identity, Reduce reduce, Combine combine) {
+        std::vector<const std::pair<const K, V>*> entries = entriesOf(map);
+        return reduceItems(entries.size(), [&entries](size_t i) -> const V& { return entries[i]->second; }, std::move(identity), reduce, combine);
+    }
+
+    template<typename K, typename V, typename R, typename Reduce>
+    static R reduced(const SwMap<K, V>& map, R identity, Reduce reduce) {
+        return reduced(map, std::move(identity), reduce, reduce);
+    }
+
+    /**
+     * @brief Sorts `list` in place with `compare`.
+     *
+     * The list is cut into blocks sorted in parallel, then merged pairwise, each round of merges
+     * running in parallel too. Short lists are sorted directly. Not stable.
+     * `SwMap` is ordered by key already; sort its `values()` to order by value.
+     */
+    template<typename T, typename Compare>
+    static void sort(SwList<T>& list, Compare compare) {
+        const size_t count = list.size();
+        const size_t threads = static_cast<size_t>(SwThreadPool::globalInstance()->maxThreadCount());
+        T* items = list.data();
+        if (count < 2 * MinSortBlock || threads < 2) {
+            std::sort(items, items + count, compare);
+            return;
+        }
+        size_t blocks = 1;
+        while (blocks < threads * 2 && count / (blocks * 2) >= MinSortBlock) {
+            blocks *= 2;
+        }
+        auto bound = [count, blocks](size_t block) {
+            return (std::min)(count, block * (count / blocks) + (std::min)(block, count % blocks));
+        };
+        parallelFor(blocks, [&](size_t begin, size_t end) {
+            for (size_t block = begin; block < end; ++block) {
+                std::sort(items + bound(block), items + bound(block + 1), compare);
+            }
+        }, 1);
+        for (size_t width = 1; width < blocks; width *= 2) {
+            parallelFor(blocks / (2 * width), [&](size_t begin, size_t end) {
+                for (size_t pair = begin; pair < end; ++pair) {
+                    size_t first = pair * 2 * width;
+                    std::inplace_merge(items + bound(first), items + bound(first + width), items + bound(first + 2 * width), compare);
+                }
+            }, 1);
+        }
+    }
+
+    template<typename T>
+    static void sort(SwList<T>& list) {
+        sort(list, std::less<T>());
+    }
+
+    static const long long TargetChunkUs = 100; ///< Duration aimed at by an adaptive chunk, in microseconds.
+    static const size_t ChunksPerThread = 4;    ///< Adaptive chunks never exceed `count / (threads * ChunksPerThread)`.
+    static const size_t MinSortBlock = 4096;    ///< Smallest block `sort` sorts on its own.
+
+private:
+    /**
+     * @brief Calls `function` and stores its result, or its exception, into `target` (a
+     *        `SwPromise` or a `SwFutureState`).
+     */
+    template<typename Target, typename F>
+    static void compute(Target& target, F& function, std::false_type) {
+        try {
+            target.setValue(function());
+        } catch (...) {
+            target.setException(std::current_exception());
+        }
+    }
+
+    template<typename Target, typename F>
+    static void compute(Target& target, F& function, std::true_type) {
+        try {
+            function();
+            target.setValue();
+        } catch (...) {
+            target.setException(std::current_exception());
+        }
+    }
+
+    /**
+     * @brief State of a `parallelFor`, shared by the caller and the pool threads helping it.
+     */
+    struct ParallelRun {
+        size_t count = 0; ///< Number of elements.
+        std::function<void(size_t, size_t)> body; ///< Processes a chunk; only called on a claimed chunk.
+        std::atomic<size_t> next{0}; ///< First element not handed out yet.
+        std::atomic<size_t> grain{1}; ///< Size of the next chunk.
+        std::atomic<int> active{0}; ///< Threads holding a claimed chunk.
+        size_t maxGrain = 1; ///< Upper bound of an adaptive chunk.
+        bool adaptive = true; ///< `grain` is rescaled after each chunk.
+        std::mutex mutex; ///< Protects `exception` and the wait of the caller.
+        std::condition_variable finished; ///< Wakes the caller when the last chunk ends.
+        std::exception_ptr exception; ///< First failure of `body`.
+
+        bool isComplete() const {
+            return next.load() >= count && active.load() == 0;
+        }
+    };
+
+    static void runChunks(ParallelRun& run) {
+        while (true) {
+            run.active.fetch_add(1);
+            size_t grain = run.grain.load(std::memory_order_relaxed);
+            size_t begin = run.next.fetch_add(grain);
+            if (begin >= run.count) {
+                finishChunk(run);
+                return;
+            }
+            size_t end = (std::min)(run.count, begin + grain);
+            auto start = std::chrono::steady_clock::now();
+            try {
+                run.body(begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(run.mutex);
+                if (!run.exception) {
+                    run.exception = std::current_exception();
+                }
+                run.next.store(run.count); // plus aucun bloc n'est distribué
+            }
+            if (run.adaptive) {
+                long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                double perItem = (std::max)(1.0, static_cast<double>(elapsed) / static_cast<double>(end - begin));
+                double ideal = static_cast<double>(TargetChunkUs) * 1000.0 / perItem;
+                size_t next = ideal >= static_cast<double>(run.maxGrain) ? run.maxGrain : (std::max)(static_cast<size_t>(1), static_cast<size_t>(ideal));
+                run.grain.store(next, std::memory_order_relaxed);
+            }
+            finishChunk(run);
+        }
+    }
+
+    static void finishChunk(ParallelRun& run) {
+        if (run.active.fetch_sub(1) == 1 && run.next.load() >= run.count) {
+            std::lock_guard<std::mutex> lock(run.mutex);
+            run.finished.notify_all();
+        }
+    }
+
+    template<typename R, typename Item, typename Reduce, typename Combine>
+    static R reduceItems(size_t count, Item item, R identity, Reduce& reduce, Combine& combine) {
+        std::mutex partialsMutex;
+        std::vector<std::pair<size_t, R>> partials; // (premier indice du bloc, résultat partiel)
+        parallelFor(count, [&](size_t begin, size_t end) {
+            R partial = identity;
+            for (size_t i = begin; i < end; ++i) {
+                reduce(partial, item(i));
+            }
+            std::lock_guard<std::mutex> lock(partialsMutex);
+            partials.push_back(std::make_pair(begin, std::move(partial)));
+        });
+        std::sort(partials.begin(), partials.end(), [](const std::pair<size_t, R>& a, const std::pair<size_t, R>& b) {
+            return a.first < b.first;
+        });
+        R result = std::move(identity);
+        for (std::pair<size_t, R>& partial : partials) {
+            combine(result, partial.second);
+        }
+        return result;
+    }
+
+    template<typename K, typename V>
+    static std::vector<const std::pair<const K, V>*> entriesOf(const SwMap<K, V>& map) {
+        std::vector<const std::pair<const K, V>*> entries;
+        for (const std::pair<const K, V>& entry : map) {
+            entries.push_back(&entry);
+        }
+        return entries;
+    }
+
+    template<typename R>
+    static void deliver(SwPromise<R>& promise, SwFutureState<R>& result) {
+        if (result.exception()) {
+            promise.setException(result.exception());
+            return;
+        }
+        promise.setValue(result.take());
+    }
+};
@@ -48,13 +48,47 @@
 #include <condition_variable>
 #include <limits>
 #include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#if defined(_WIN32)
 #include <windows.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 #include "SwMap.h"
 #include "SwString.h"
+#include "SwEventDispatcher.h"
+#include "SwTimerHeap.h"
+#include "SwClock.h"
+#include "SwEventQueue.h"
+#include "SwFiberPool.h"
+#include "SwFiberReadyList.h"
+#include "SwFiberScheduler.h"
+#include "SwRuntimeScheduler.h"
+#include "SwLoopTelemetry.h"
+#include "SwRealtime.h"
 #include <thread>
 
 
 
+/**
+ * @enum ExecutionHint
+ * @brief Tells the event loop where a posted event or a timer callback should run.
+ *
+ * - `Fiber`: the callback runs in a pooled fiber and may yield (default).
+ * - `Inline`: the callback runs directly on the main context, saving the two context switches of a
+ *   fiber. Meant for short callbacks that never yield. If one does call `yieldFiber`, `release` or
+ *   `SwEventLoop::swsleep`, the loop detects it: the wait is served by a nested loop on the main
+ *   context and a timer is promoted to fiber execution for its next ticks.
+ */
+enum class ExecutionHint {
+    Fiber,
+    Inline
+};
+
 /**
  * @brief Internal class representing a high-precision timer that executes a callback at specified intervals.
  *
@@ -73,6 +107,9 @@
  * - **Utility Functions**:
  *   - Determines readiness of the timer with `isReady`.
  *   - Calculates the time remaining until the timer is ready with `timeUntilReady`.
+ * - **Deadline Scheduling**:
+ *   - Keeps the absolute `deadline` of the next expiration, which `SwCoreApplication` indexes in a
+ *     `SwTimerHeap` so that idle timers are never scanned.
  *
  * ### Usage:
  * 1. Create an instance of `_T` with a callback function, interval (in microseconds), and
@@ -105,10 +142,11 @@ public:
      * @param singleShot If `true`, the timer fires only once and must be manually removed after execution.
      */
     _T(std::function<void()> callback, int interval, bool singleShot = false)
-        : callback(callback),
+        : callback(std::move(callback)),
         interval(interval),
         singleShot(singleShot),
-        lastExecutionTime(std::chrono::steady_clock::now())
+        lastExecutionTime(SwClock::now()),
+        deadline(lastExecutionTime + std::chrono::microseconds(interval))
     {}
 
     /**
@@ -116,15 +154,22 @@ public:
      * @return `true` if the timer is ready, otherwise `false`.
      */
     bool isReady() const {
-        auto now = std::chrono::steady_clock::now();
-        return std::chrono::duration_cast<std::chrono::microseconds>(now - lastExecutionTime).count() >= interval;
+        return isReady(SwClock::now());
+    }
+
+    /**
+     * @brief Checks if the timer is ready to fire at the given time.
+     * @param now Current time, read once per loop iteration by the caller.
+     */
+    bool isReady(std::chrono::steady_clock::time_point now) const {
+        return now >= deadline;
     }
 
     /**
      * @brief Executes the timer's callback and updates the last execution time.
      */
     void execute() {
-        lastExecutionTime = std::chrono::steady_clock::now();
+        lastExecutionTime = SwClock::now();
         callback();
     }
 
@@ -133,9 +178,16 @@ public:
      * @return The time in microseconds until the timer is ready, or `0` if the timer is already ready.
      */
     int timeUntilReady() const {
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - lastExecutionTime).count();
-        return (std::max)(0, interval - static_cast<int>(elapsed));
+        return timeUntilReady(SwClock::now());
+    }
+
+    /**
+     * @brief Calculates the time remaining until the timer is ready at the given time.
+     * @param now Current time, read once per loop iteration by the caller.
+     */
+    int timeUntilReady(std::chrono::steady_clock::time_point now) const {
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+        return remaining > 0 ? static_cast<int>(remaining) : 0;
     }
 
 private:
@@ -143,12 +195,20 @@ private:
     int interval; ///< Interval in microseconds between timer executions.
     bool singleShot; ///< Indicates if the timer is single-shot (`true`) or recurring (`false`).
     std::chrono::steady_clock::time_point lastExecutionTime; ///< The last time the timer was executed.
+    std::chrono::steady_clock::time_point deadline; ///< Absolute time of the next expiration.
+    ExecutionHint executionHint = ExecutionHint::Fiber; ///< Inline timers fall back to `Fiber` once they yield.
+    uint64_t scheduleOrder = 0; ///< Order of the live heap entry; entries with another order are stale.
+    int activeCalls = 0; ///< Callback invocations in progress (a fiber may have yielded inside one).
+    bool cancelled = false; ///< Set once the timer is removed; deletion waits for `activeCalls` to drop to 0.
+    const char* telemetryTag = nullptr; ///< `SwTelemetryTag` active when the timer was armed.
 };
 
 
 
+#if defined(_WIN32)
 // Déclaration du gestionnaire
 static BOOL WINAPI ConsoleHandler(DWORD ctrlType);
+#endif
 
 
 /**
@@ -168,12 +228,18 @@ static BOOL WINAPI ConsoleHandler(DWORD ctrlType);
  *   - Allows adding, removing, and managing timers with microsecond-level precision.
  *   - Supports single-shot and recurring timers.
  * - **Fiber-Based Multitasking**:
- *   - Implements cooperative multitasking using Windows fibers.
+ *   - Implements cooperative multitasking using `SwFiber` (Windows fibers, or a hand-written
+ *     context switch on Linux).
  *   - Provides `yieldFiber` and `unYieldFiber` for pausing and resuming task execution.
- *   - Ensures efficient resource management for fibers through mechanisms like `release` and `deleteFiberIfNeeded`.
+ *   - Fibers are taken from a `SwFiberPool` and reused once their task returns, so an event costs
+ *     two context switches instead of a fiber creation (see `fiberPool()`).
  * - **High-Precision Timing**:
  *   - Uses multimedia timers on Windows for enhanced precision in timer scheduling.
  *   - Ensures consistent timing behavior across tasks and events.
+ * - **Blocking Reactor**:
+ *   - When idle, the loop blocks in `SwEventDispatcher` (epoll on Linux, waitable handles on
+ *     Windows) until the next timer deadline, a `postEvent` from any thread or a ready descriptor.
+ *   - Descriptors can be watched with `registerDescriptor` instead of being polled by a timer.
  *
  * ### Workflow:
  * 1. The main event loop (`exec`) continuously processes events and manages timers.
@@ -191,13 +257,22 @@ static BOOL WINAPI ConsoleHandler(DWORD ctrlType);
  * @note This class is designed for applications requiring precise control over asynchronous tasks,
  *       such as real-time systems or applications with complex scheduling requirements.
  *
- * @warning This class heavily relies on Windows-specific APIs (fibers and multimedia timers).
- *          It is not portable to non-Windows platforms.
+ * @warning The loop itself runs on Windows and Linux: fibers (`SwFiber`) and the reactor
+ *          (`SwEventDispatcher`, `MsgWaitForMultipleObjects` on Windows, `epoll` on Linux) have
+ *          a backend for each. These parts remain Windows-only and are compiled out on Linux:
+ *          - the console handler (`SetConsoleCtrlHandler` / `ConsoleHandler`);
+ *          - the watchdog's `forceBackToMainFiber`, which rewrites the Win32 context of the loop
+ *            thread; on Linux a blocking fiber is only reported;
+ *          - high-precision timers (`timeBeginPeriod`) and `setHighThreadPriority`.
+ *          A full Linux build is still blocked by dependencies outside the loop, such as
+ *          `SwCrypto` (bcrypt, pulled in by `SwString`) and `SwFont` (GDI).
  */
 class SwCoreApplication {
 
     friend class SwTimer;
     friend class SwEventLoop;
+    friend class SwShardedRuntime;
+    friend class SwFiberScheduler;
 
 public:
     /**
@@ -207,13 +282,14 @@ public:
      */
     SwCoreApplication()
         : running(true), exitCode(0) {
-        instance(false) = this;
+        registerInstance(true);
         enableHighPrecisionTimers();
         initFibers();
+#if defined(_WIN32)
         SetConsoleCtrlHandler(ConsoleHandler, TRUE);
-        // Sauvegarde du handle du thread principal
-        mainThreadHandle = GetCurrentThread();
-        mainThreadId = GetCurrentThreadId();
+#endif
+        // Sauvegarde du thread principal
+        captureMainThread();
     }
 
     /**
@@ -226,14 +302,15 @@ public:
      */
     SwCoreApplication(int argc, char* argv[])
         : running(true), exitCode(0) {
-        instance(false) = this;
+        registerInstance(true);
         enableHighPrecisionTimers();
         parseArguments(argc, argv);
         initFibers();
+#if defined(_WIN32)
         SetConsoleCtrlHandler(ConsoleHandler, TRUE);
-        // Sauvegarde du handle du thread principal
-        mainThreadHandle = GetCurrentThread();
-        mainThreadId = GetCurrentThreadId();
+#endif
+        // Sauvegarde du thread principal
+        captureMainThread();
     }
 
     /**
@@ -242,21 +319,56 @@ public:
      * Disables high-precision timers and performs necessary cleanup.
      */
     virtual ~SwCoreApplication() {
+        releaseBlockedProducers();
+        for (SwEventQueue::Node* node : m_keptEvents) {
+            SwEventQueue::release(node);
+        }
         disableHighPrecisionTimers();
+        if (threadInstance() == this) {
+            threadInstance() = nullptr;
+        }
+        if (mainInstance() == this) {
+            mainInstance() = nullptr;
+        }
     }
 
     /**
-     * @brief Accesses the static instance of the application.
+     * @brief Accesses the event loop of the calling thread.
+     *
+     * Each thread running an event loop (the main application, or a loop of `SwShardedRuntime`)
+     * has its own `SwCoreApplication`, with its own timers, fibers and event queue. From inside a
+     * callback this returns the loop running the callback. Threads without a loop get the main
+     * application (the first one created), which is what producer threads posting events expect.
+     *
      * @param create If `true` and the instance does not exist, creates one.
-     * @return Reference to the static application instance pointer.
+     * @return Reference to the application instance pointer.
      */
     static SwCoreApplication*& instance(bool create = true) {
-        static SwCoreApplication* _mainApp = nullptr;
+        SwCoreApplication*& current = threadInstance();
+        if (current) {
+            return current;
+        }
+        SwCoreApplication*& _mainApp = mainInstance();
         if(!_mainApp && create)
             _mainApp = new SwCoreApplication();
         return _mainApp;
     }
 
+    /**
+     * @brief Returns the event loop owned by the calling thread, or `nullptr` if it has none.
+     */
+    static SwCoreApplication* currentLoop() {
+        return threadInstance();
+    }
+
+    /**
+     * @brief Returns a process-wide unique identifier for `yieldFiber` / `unYieldFiber`.
+     */
+    static int generateYieldId() {
+        static std::atomic<int> s_nextYieldId(0);
+        return s_nextYieldId++;
+    }
+
     void activeWatchDog() {
         // Si le watchdog n'est pas déjà actif
         if (!watchdogRunning) {
@@ -284,65 +396,201 @@ public:
         return 100.0 * (double)totalBusyTimeMicroseconds / (double)totalTimeMicroseconds;
     }
 
-    double getLastSecondLoadPercentage() {
-        auto now = std::chrono::steady_clock::now();
-        auto oneSecondAgo = now - std::chrono::seconds(1);
+    /**
+     * @brief Busy share of the loop over the last second, in percent.
+     * @see SwLoopTelemetry::load for the 10 s and 60 s windows.
+     */
+    double getLastSecondLoadPercentage() const {
+        return m_telemetry.load(1);
+    }
+
+    /**
+     * @brief Posts an event (a function) to the event queue.
+     *
+     * Safe to call from any thread and lock-free: the callable is moved into a pooled
+     * `SwEventQueue` node, without heap allocation when its captures fit in
+     * `SwEventQueue::InlineSize` bytes.
+     *
+     * When the queue is bounded (`setEventQueueCapacity`) and full, the `OverloadPolicy` decides
+     * what happens to the event.
+     *
+     * @param event Function to execute during event processing.
+     * @return `false` if the event was discarded by `OverloadPolicy::DropNewest` or refused by
+     *         `OverloadPolicy::Reject`.
+     */
+    template<typename Callable>
+    bool postEvent(Callable&& event) {
+        return postEvent(std::forward<Callable>(event), ExecutionHint::Fiber);
+    }
 
-        // On supprime les mesures plus vieilles que 1 seconde
-        while (!measurements.empty() && measurements.front().timestamp < oneSecondAgo) {
-            measurements.pop_front();
+    /**
+     * @brief Posts an event with an explicit execution hint.
+     *
+     * With `ExecutionHint::Inline` the event runs on the main context without a fiber switch:
+     * ```cpp
+     * app.postEvent([this]() { ++m_counter; }, ExecutionHint::Inline);
+     * ```
+     *
+     * @param event Function to execute during event processing.
+     * @param hint Where the event runs, see `ExecutionHint`.
+     * @return `false` if the overload policy discarded or refused the event.
+     */
+    template<typename Callable>
+    bool postEvent(Callable&& event, ExecutionHint hint) {
+        if (!admitEvent()) {
+            return false;
         }
+        pushEvent(std::forward<Callable>(event), hint == ExecutionHint::Inline ? InlineEventFlag : 0u);
+        return true;
+    }
 
-        uint64_t sumBusy = 0;
-        uint64_t sumTotal = 0;
-        for (auto &m : measurements) {
-            sumBusy += m.busyMicroseconds;
-            sumTotal += m.totalMicroseconds;
-        }
+    /**
+     * @brief Posts an event that bypasses the capacity of the queue and is never dropped.
+     *
+     * Reserved to the completions the loop needs in order to make progress (fiber and coroutine
+     * wakeups, future results, deferred deletions): dropping one would strand whoever waits on
+     * it, and blocking the poster could deadlock the loop. The event still counts in the depth.
+     */
+    template<typename Callable>
+    void postEventUnbounded(Callable&& event, ExecutionHint hint = ExecutionHint::Fiber) {
+        pushEvent(std::forward<Callable>(event),
+                  (hint == ExecutionHint::Inline ? InlineEventFlag : 0u) | UnboundedEventFlag);
+    }
 
-        if (sumTotal == 0) return 0.0;
-        return 100.0 * (double)sumBusy / (double)sumTotal;
+    /**
+     * @brief Watches a descriptor and runs a callback in the event loop when it becomes ready.
+     *
+     * The callback is executed inside a fiber, like any other event, with the ready flags
+     * (`SwEventDispatcher::ReadEvent`, `WriteEvent`, `ErrorEvent`) as argument. Readiness is
+     * level-triggered: the callback must consume it or it will be called again.
+     *
+     * ### Example:
+     * ```cpp
+     * int id = app.registerDescriptor(fd, SwEventDispatcher::ReadEvent, [fd](int events) {
+     *     char buffer[512];
+     *     ::read(fd, buffer, sizeof(buffer));
+     * });
+     * ```
+     *
+     * @param descriptor File descriptor (Linux) or waitable `HANDLE` (Windows, e.g. a `WSAEVENT`).
+     * @param events Combination of `SwEventDispatcher::DescriptorEvent` flags.
+     * @param callback Function called with the ready flags.
+     * @return A registration identifier to pass to `unregisterDescriptor`, or `-1` on failure.
+     */
+    int registerDescriptor(SwEventDispatcher::Descriptor descriptor, int events, std::function<void(int)> callback) {
+        int id = dispatcher.registerDescriptor(descriptor, events, callback);
+        dispatcher.wakeUp(); // la nouvelle registration doit être prise en compte par une attente en cours
+        return id;
     }
 
     /**
-     * @brief Posts an event (a function) to the event queue.
-     * @param event Function to execute during event processing.
+     * @brief Changes the readiness conditions watched for a registered descriptor.
+     * @param id Identifier returned by `registerDescriptor`.
+     * @param events New combination of `SwEventDispatcher::DescriptorEvent` flags.
+     * @return `true` on success.
      */
-    void postEvent(std::function<void()> event) {
-        {
-            std::lock_guard<std::mutex> lock(eventQueueMutex);
-            eventQueue.push(event);
+    bool updateDescriptor(int id, int events) {
+        return dispatcher.updateDescriptor(id, events);
+    }
+
+    /**
+     * @brief Stops watching a descriptor. The descriptor itself is left open.
+     * @param id Identifier returned by `registerDescriptor`.
+     */
+    void unregisterDescriptor(int id) {
+        if (id >= 0) {
+            dispatcher.unregisterDescriptor(id);
         }
-        cv.notify_one();
     }
 
     /**
      * @brief Adds a timer.
      * @param callback Function to call when the timer expires.
      * @param interval Interval in microseconds between two executions of the callback.
+     * @param singleShot If `true`, the timer is removed after its first execution.
+     * @param hint `ExecutionHint::Inline` runs the callback on the main context until it first yields.
      * @return The identifier of the created timer.
      */
-    int addTimer(std::function<void()> callback, int interval, bool singleShot = false) {
-        int timerId = nextTimerId++;
-        timers.emplace(timerId, new _T(callback, interval, singleShot));
+    int addTimer(std::function<void()> callback, int interval, bool singleShot = false,
+                 ExecutionHint hint = ExecutionHint::Fiber) {
+        int timerId = reserveTimerId();
+        registerTimer(timerId, std::move(callback), interval, singleShot, hint);
         return timerId;
     }
 
+    /**
+     * @brief Reserves a timer identifier. Safe from any thread.
+     *
+     * Lets another thread name a timer before posting its `registerTimer` to this loop.
+     */
+    int reserveTimerId() {
+        return nextTimerId.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Adds a timer under an identifier obtained from `reserveTimerId`.
+     *
+     * Same as `addTimer` otherwise; like it, it must run on the thread of this loop.
+     */
+    void registerTimer(int timerId, std::function<void()> callback, int interval, bool singleShot = false,
+                       ExecutionHint hint = ExecutionHint::Fiber) {
+        _T* timer = new _T(std::move(callback), interval, singleShot);
+        timer->executionHint = hint;
+        timer->telemetryTag = SwLoopTelemetry::currentTag();
+        timers.emplace(timerId, timer);
+        pushTimerEntry(timerId, timer);
+    }
+
     /**
      * @brief Removes a timer.
+     *
+     * The removal is O(1): the timer is forgotten immediately and its heap entry is discarded
+     * lazily when it reaches the top. It is safe to call from inside the timer's own callback.
+     *
      * @param timerId Identifier of the timer to remove.
      */
     void removeTimer(int timerId) {
         auto it = timers.find(timerId);
         if (it != timers.end()) {
-            delete it->second;
+            _T* timer = it->second;
             timers.erase(it);
+            releaseTimer(timer);
         }
-        auto itOld = timers.find(-1);
-        if (itOld != timers.end()) {
-            delete itOld->second;
-            timers.erase(itOld);
+    }
+
+    /**
+     * @brief Returns `true` while the timer is armed (a fired single-shot timer is no longer).
+     */
+    bool hasTimer(int timerId) const {
+        return timers.find(timerId) != timers.end();
+    }
+
+    /**
+     * @brief Suspends the calling fiber until `deadline`, without allocating anything.
+     *
+     * The fiber itself is pushed on the timer heap: no `_T`, no `yieldFiber` identifier and no
+     * extra fiber are involved. When the deadline passes, the loop moves the fiber straight to its
+     * ready list. This is the path taken by `SwEventLoop::swsleep` in a fiber.
+     *
+     * @return `false` if the caller is not a fiber of an event loop (main context, inline
+     *         callback, `SwFiberScheduler` task); nothing is done in that case.
+     *
+     * @note The sleep cannot be interrupted; use `yieldFiber` / `unYieldFiber` with a timer for a
+     *       cancellable wait.
+     */
+    static bool sleepFiberUntil(std::chrono::steady_clock::time_point deadline) {
+        SwCoreApplication* app = instance(false);
+        SwFiber* current = SwFiber::current();
+        if (!app || current == app->mainFiber || SwFiberScheduler::currentScheduler()) {
+            return false;
         }
+        current->setState(SwFiber::Yielded);
+        SwTimerHeap::Entry entry = { deadline, ++app->timerScheduleOrder, SwTimerHeap::SleeperId, current };
+        app->timerHeap.push(entry);
+        ++app->m_sleepingFibers;
+
+        SwFiber::switchTo(app->mainFiber);
+        return true;
     }
 
     /**
@@ -353,21 +601,20 @@ public:
      * for the duration of the loop.
      *
      * ### Workflow:
-     * 1. Sets the thread priority to high using `setHighThreadPriority`.
+     * 1. Sets the thread priority to high using `setHighThreadPriority`, unless a real-time
+     *    scheduling class was applied with `setRealtimeProfile`.
      * 2. Records the start time of the loop for duration tracking.
      * 3. Enters the main loop:
      *    - Processes events using `processEvent`, which also handles timers and fibers.
-     *    - Calculates the elapsed time since the last iteration and adjusts the sleep duration
-     *      to maintain timing precision.
      *    - Checks the total elapsed time and exits the loop if it exceeds the maximum duration.
-     *    - Introduces a short sleep to prevent CPU overuse and allow for other tasks to execute.
+     *    - When nothing is runnable, blocks in the `SwEventDispatcher` until the next timer
+     *      deadline, a `postEvent` from any thread or a ready descriptor.
      * 4. Exits the loop and returns the application's exit code.
      *
      * @param maxDurationMicroseconds Maximum time the loop should run, in microseconds.
      * @return The application's exit code, typically set using `exit()` or `quit()`.
      *
-     * @note The loop ensures the system remains responsive by balancing event processing
-     *       and controlled delays.
+     * @note An idle loop consumes no CPU: it sleeps in the kernel instead of polling.
      *
      * @warning Ensure that the `running` flag is managed correctly to avoid infinite loops.
      *          If the application is terminated before the duration expires, the loop will exit early.
@@ -376,7 +623,9 @@ public:
      *          for a fixed duration, such as for testing or temporary tasks.
      */
     virtual int exec(int maxDurationMicroseconds = 0) {
-        setHighThreadPriority();
+        if (!m_realtimePriority) {
+            setHighThreadPriority(); // ne rabaisse pas une priorité temps réel déjà posée
+        }
         auto startTime = std::chrono::steady_clock::now();
         auto lastTime = startTime;
 
@@ -395,28 +644,20 @@ public:
             // On ajoute à totalBusyTimeMicroseconds le temps occupé de cette itération
             totalBusyTimeMicroseconds += (uint64_t)busyElapsedIteration;
 
-            // On enregistre la mesure de cette itération
-            measurements.push_back({
-                currentTime,
-                (uint64_t)busyElapsedIteration,
-                (uint64_t)elapsed
-            });
-
-            // Nettoyage des mesures plus vieilles que 1 seconde
-            auto oneSecondAgo = currentTime - std::chrono::seconds(1);
-            while (!measurements.empty() && measurements.front().timestamp < oneSecondAgo) {
-                measurements.pop_front();
-            }
+            // On enregistre la mesure de cette itération dans les fenêtres de charge
+            m_telemetry.addIteration(currentTime, busyElapsedIteration, (uint64_t)elapsed);
 
             auto totalElapsed = std::chrono::duration_cast<std::chrono::microseconds>(currentTime - startTime).count();
             if (maxDurationMicroseconds != 0 && totalElapsed >= maxDurationMicroseconds) {
                 break;
             }
 
-            int adjustedSleepDuration = (std::max)(0, sleepDuration - (int)elapsed);
-            if(adjustedSleepDuration > 1000){
-                std::this_thread::sleep_for(std::chrono::microseconds(adjustedSleepDuration / 2));
+            int timeout = sleepDuration;
+            if (maxDurationMicroseconds != 0) {
+                int remaining = (std::max)(0, maxDurationMicroseconds - (int)totalElapsed);
+                timeout = (timeout < 0) ? remaining : (std::min)(timeout, remaining);
             }
+            waitForEvents(timeout);
         }
         return exitCode;
     }
@@ -431,10 +672,13 @@ public:
      *
      * ### Workflow:
      * 1. **Event Handling**:
-     *    - If the event queue is empty and `waitForEvent` is `true`, the function waits for a new
-     *      event or timer expiration using a condition variable.
-     *    - If an event is available, it is extracted from the queue and executed within a fiber
-     *      using `runEventInFiber`. The function returns `0` after processing the event.
+     *    - If the event queue and timer list are empty and `waitForEvent` is `true`, the function
+     *      blocks in the `SwEventDispatcher` until an event is posted or a descriptor is ready.
+     *    - A batch of posted events, bounded by the `DrainPolicy` (event count and time budget), is
+     *      popped from the lock-free queue and each one is executed within a fiber using
+     *      `runEventInFiber` (or inline, see `ExecutionHint`).
+     *    - Timers and ready fibers are serviced after every batch, so a flood of posted events
+     *      cannot starve them.
      * 2. **Timer Management**:
      *    - Iterates through the list of active timers and checks if they are ready to execute.
      *    - Executes callbacks for ready timers within fibers:
@@ -444,17 +688,21 @@ public:
      * 3. **Fiber Management**:
      *    - Calls `resumeReadyFibers` to handle fibers that were previously paused and are now
      *      ready to run.
-     * 4. **Return Value**:
+     * 4. **Idle Tasks**:
+     *    - Runs chunks of the tasks posted with `postIdleTask` while nothing else is pending (see
+     *      `processIdleTasks`).
+     * 5. **Return Value**:
      *    - If an event or a timer is processed, the function returns `0`.
-     *    - Otherwise, it returns the time in microseconds until the next timer is ready, or a
-     *      small default value if no timers are active.
+     *    - Otherwise, it returns the time in microseconds until the next timer is ready, or `-1`
+     *      if no timers are active.
      *
      * @param waitForEvent If `true`, blocks and waits for an event to arrive if the event queue and
      *                     timer list are empty.
-     * @return The time in microseconds until the next timer expires, or `0` if an event is imminent.
+     * @return The time in microseconds until the next timer expires, `0` if an event is imminent,
+     *         or `-1` if nothing is scheduled.
      *
-     * @note This function ensures thread-safe access to the event queue and timer list using
-     *       `std::mutex` locks.
+     * @note The event queue is lock-free and may be fed from any thread; the timer list is only
+     *       touched by the thread running the loop.
      *
      * @warning Timer callbacks and events are executed within fibers. Care must be taken to ensure
      *          that these callbacks do not block or cause deadlocks.
@@ -463,33 +711,39 @@ public:
      *          application to drive the event and timer system.
      */
     int processEvent(bool waitForEvent = false) {
-        std::unique_lock<std::mutex> lock(eventQueueMutex);
-
         // Wait for an event if the queue is empty and waiting is allowed
-        if (eventQueue.empty() && timers.empty() && waitForEvent) {
-            cv.wait(lock);
+        if (waitForEvent && timerHeap.isEmpty() && !hasQueuedEvents() && idleTaskCount() == 0) {
+            waitForEvents(-1);
         }
 
-        // Process the next event if available
-        if (!eventQueue.empty()) {
-            auto event = eventQueue.front();
-            eventQueue.pop();
-            lock.unlock(); // Unlock before running the event in a fiber
-            runEventInFiber(event);
-            return 0; // An event was processed, so no delay is required
-        }
-        lock.unlock();
+        // Drain a batch of posted events
+        bool eventProcessed = processQueuedEvents(m_drainPolicy) > 0;
 
-        // Process timer and get ne next Rendez-vous
-        int minTimeUntilNext = processTimers();
+        // Process due timers
+        processTimers();
 
         // Resume fibers that are ready to run
         resumeReadyFibers();
 
-        if (!eventQueue.empty()) {
-            return 0;
+        m_wokeFromIdle = false; // réveil mesuré, ou dû à un descripteur
+
+        // Background work, once nothing else is pending
+        bool idleRemaining = processIdleTasks();
+
+        // Les fibres reprises ont pu armer un timer ou se rendormir : le prochain rendez-vous est lu après
+        const auto now = SwClock::now(clock());
+        int minTimeUntilNext = timeUntilNextTimer(now);
+        if (idleRemaining) {
+            minTimeUntilNext = (std::min)(minTimeUntilNext, timeUntilIdleDeadline(now));
+        }
+
+        if (eventProcessed || hasQueuedEvents()) {
+            return 0; // An event was processed, so no delay is required
         }
-        return minTimeUntilNext != (std::numeric_limits<int>::max)() ? minTimeUntilNext : 10;
+        if (idleRemaining && hasQueuedIdleTasks() && isIdleFor(std::chrono::microseconds(m_idleHorizon))) {
+            return 0; // la passe idle a épuisé son budget : on sonde les descripteurs puis on continue
+        }
+        return minTimeUntilNext != (std::numeric_limits<int>::max)() ? minTimeUntilNext : -1;
     }
 
     /**
@@ -497,8 +751,7 @@ public:
      * @return `true` if there are pending events or timers, `false` otherwise.
      */
     bool hasPendingEvents() {
-        std::lock_guard<std::mutex> lock(eventQueueMutex);
-        return !eventQueue.empty() || !timers.empty();
+        return hasQueuedEvents() || !timers.empty();
     }
 
     /**
@@ -515,24 +768,24 @@ public:
      */
     void quit() {
         running = false;
-        cv.notify_all();
+        dispatcher.wakeUp();
     }
 
     /**
      * @brief Releases the current fiber and queues it for re-execution in the event loop.
      *
      * This function is used to pause the execution of the current fiber and move it to the
-     * `s_readyFibers` queue, enabling it to be resumed during the next iteration of the event loop.
+     * `readyFibers` queue, enabling it to be resumed during the next iteration of the event loop.
      * Once the fiber is released, execution switches back to the main fiber.
      *
      * ### Workflow:
-     * 1. Retrieve the current fiber using `GetCurrentFiber`.
+     * 1. Retrieve the current fiber using `SwFiber::current`.
      * 2. Check if the current fiber is the main fiber:
      *    - If true, the function ignores the release operation and returns immediately, as the main
      *      fiber cannot be paused or queued.
-     * 3. Lock the `s_readyMutex` to ensure thread-safe access to the `s_readyFibers` queue.
-     * 4. Add the current fiber to the `s_readyFibers` queue.
-     * 5. Switch execution back to the main fiber using `SwitchToFiber`.
+     * 3. Lock the `readyMutex` to ensure thread-safe access to the `readyFibers` queue.
+     * 4. Add the current fiber to the `readyFibers` queue.
+     * 5. Switch execution back to the main fiber using `SwFiber::switchTo`.
      *
      * @note This function differs from `yieldFiber` in that the fiber is immediately queued for
      *       re-execution without requiring an explicit call to resume it (e.g., via `unYieldFiber`).
@@ -544,19 +797,27 @@ public:
      *          participate in cooperative multitasking.
      */
     static void release() {
+        if (SwFiberScheduler::currentScheduler()) {
+            // Tâche d'un SwFiberScheduler : elle repasse par la file partagée
+            SwFiberScheduler::yield();
+            return;
+        }
         SwCoreApplication* app = instance(false);
-        LPVOID current = GetCurrentFiber();
+        SwFiber* current = SwFiber::current();
         if (current == app->mainFiber) {
-            // Not in the event loop; ignore yielding
+            // Not in the event loop (or in an inline callback, which is then flagged); ignore yielding
+            if (app->inlineDepth > 0) {
+                app->inlineYieldDetected = true;
+            }
             return;
         }
         {
-            std::lock_guard<std::mutex> lock(getReadyMutex());
-            getReadyFibers().push(current);
+            std::lock_guard<std::mutex> lock(app->getReadyMutex());
+            app->getReadyFibers().push(current); // passe la fibre à l'état Ready
         }
 
         // Retour à la fibre principale
-        SwitchToFiber(app->mainFiber);
+        SwFiber::switchTo(app->mainFiber);
     }
 
     /**
@@ -567,13 +828,13 @@ public:
      * switches execution back to the main fiber, allowing other fibers or tasks to run.
      *
      * ### Workflow:
-     * 1. Retrieve the current fiber using `GetCurrentFiber`.
+     * 1. Retrieve the current fiber using `SwFiber::current`.
      * 2. If the current fiber is the main fiber, yielding is ignored since it is not part of the
      *    cooperative multitasking system.
      * 3. If the current fiber is not the main fiber:
      *    - Lock the `s_yieldMutex` to ensure thread-safe access to the `s_yieldedFibers` map.
      *    - Store the current fiber in the map with the specified `id` as the key.
-     * 4. Switch execution back to the main fiber using `SwitchToFiber`.
+     * 4. Switch execution back to the main fiber using `SwFiber::switchTo`.
      *
      * @param id The unique identifier to associate with the yielded fiber.
      *
@@ -581,26 +842,81 @@ public:
      *       `unYieldFiber` with the same `id`.
      *
      * @warning If the main fiber attempts to yield itself, the function will exit without performing
-     *          any operation, as yielding is only valid for non-main fibers.
+     *          any operation, as yielding is only valid for non-main fibers. The exception is a
+     *          callback running with `ExecutionHint::Inline`: the loop keeps running nested on the
+     *          main context until `unYieldFiber(id)` is called.
      *
      * @remarks This function is critical for implementing cooperative multitasking, where fibers
      *          voluntarily yield control to enable other fibers or tasks to execute.
      */
     static void yieldFiber(int id) {
+        if (SwFiberScheduler* scheduler = SwFiberScheduler::currentScheduler()) {
+            if (commitYield(id, YieldedFiber{SwFiber::current(), nullptr, scheduler, false, false})) {
+                scheduler->park();
+            }
+            return;
+        }
         SwCoreApplication* app = instance(false);
-        LPVOID current = GetCurrentFiber();
+        SwFiber* current = SwFiber::current();
         if (current == app->mainFiber) {
+            if (app->inlineDepth > 0) {
+                // Inline callback that wants to wait: serve it with a nested loop
+                app->inlineYieldDetected = true;
+                app->waitInline(id);
+            }
             // Not in the event loop; ignore yielding
             return;
         }
         // Store the current fiber in the yielded fibers map
-        {
-            std::lock_guard<std::mutex> lock(getYieldMutex());
-            getYieldedFibers()[id] = current;
+        current->setState(SwFiber::Yielded);
+        if (!commitYield(id, YieldedFiber{current, app, nullptr, false, false})) {
+            current->setState(SwFiber::Running); // déjà réveillée (voir prepareYield)
+            return;
         }
 
         // Switch execution back to the main fiber
-        SwitchToFiber(app->mainFiber);
+        SwFiber::switchTo(app->mainFiber);
+    }
+
+    /**
+     * @brief Announces that the calling context is about to `yieldFiber(id)`.
+     *
+     * Without it, an `unYieldFiber(id)` that runs before `yieldFiber(id)` (typically on another
+     * thread, right after `id` was handed over) finds nothing to wake and is lost. After
+     * `prepareYield(id)`, such an early wake is remembered and `yieldFiber(id)` returns at once.
+     *
+     * ```cpp
+     * int id = SwCoreApplication::generateYieldId();
+     * SwCoreApplication::prepareYield(id);
+     * startRequest([id]() { SwCoreApplication::unYieldFiber(id); }); // may complete on any thread
+     * SwCoreApplication::yieldFiber(id);
+     * ```
+     */
+    static void prepareYield(int id) {
+        std::lock_guard<std::mutex> lock(getYieldMutex());
+        getYieldedFibers()[id] = YieldedFiber{nullptr, nullptr, nullptr, true, false};
+    }
+
+    /**
+     * @brief Returns `true` if `yieldFiber` can suspend the calling code.
+     *
+     * That is the case in a fiber of the calling thread's event loop, in an inline callback
+     * (served by a nested loop) and in a `SwFiberScheduler` task. Elsewhere (before `exec()`, on
+     * a thread without event loop) `yieldFiber` returns immediately and the caller must block.
+     */
+    static bool canYield() {
+        if (SwFiberScheduler::currentScheduler()) {
+            return true;
+        }
+        SwCoreApplication* app = instance(false);
+        SwFiber* current = SwFiber::current();
+        if (!app || !current) {
+            return false;
+        }
+        if (current == app->mainFiber) {
+            return app->inlineDepth > 0;
+        }
+        return SwFiber::currentThreadFiber() == app->mainFiber;
     }
 
     /**
@@ -609,22 +925,25 @@ public:
      * This function handles the transition of a fiber from the "yielded" state back to the "ready"
      * state. It locates the fiber associated with the specified identifier (`id`) in the
      * `s_yieldedFibers` map. If the fiber is found, it is removed from the yielded fibers map and
-     * added to the `s_readyFibers` queue. Fibers in the ready queue will be resumed by the main
+     * added to the `readyFibers` queue. Fibers in the ready queue will be resumed by the main
      * fiber during the event loop execution.
      *
      * ### Workflow:
-     * 1. Lock the `s_yieldMutex` to safely access the `s_yieldedFibers` map.
+     * 1. Lock the `s_yieldMutex` to safely access the `s_yieldedFibers` map, which records the
+     *    event loop each fiber belongs to.
      * 2. Search for the fiber using the provided `id`.
      * 3. If the fiber is found:
      *    - Extract and remove it from the `s_yieldedFibers` map.
      *    - Store the fiber pointer in a local variable.
-     * 4. Lock the `s_readyMutex` to safely push the fiber into the `s_readyFibers` queue.
+     * 4. Lock the ready mutex of the owning loop and push the fiber into its ready queue, then
+     *    wake that loop up. The fiber always resumes on the thread that suspended it, except for
+     *    tasks of a `SwFiberScheduler`, which resume on whichever worker is available.
      * 5. If the fiber is not found in `s_yieldedFibers`, no operation is performed.
      *
      * @param id The unique identifier of the fiber to un-yield.
      *
      * @note This function ensures thread safety when modifying shared data structures by using
-     *       `std::lock_guard` for both `s_yieldMutex` and `s_readyMutex`.
+     *       `std::lock_guard` for both `s_yieldMutex` and `readyMutex`.
      *
      * @warning If the `id` provided does not correspond to any fiber in `s_yieldedFibers`, the
      *          function will exit silently without performing any operation.
@@ -634,19 +953,36 @@ public:
      *          when an external event signals that the fiber should continue its execution.
      */
     static void unYieldFiber(int id) {
-        LPVOID fiber = nullptr;
+        YieldedFiber yielded = {nullptr, nullptr, nullptr, false, false};
         {
             std::lock_guard<std::mutex> lock(getYieldMutex());
             auto it = getYieldedFibers().find(id);
             if (it != getYieldedFibers().end()) {
-                fiber = it->second;
+                if (it->second.prepared) {
+                    // yieldFiber(id) n'a pas encore eu lieu : il reviendra immédiatement
+                    it->second.woken = true;
+                    return;
+                }
+                yielded = it->second; // fiber == nullptr pour une attente inline (voir waitInline)
                 getYieldedFibers().erase(it);
             }
         }
 
-        if (fiber) {
-            std::lock_guard<std::mutex> lock(getReadyMutex());
-            getReadyFibers().push(fiber);
+        if (yielded.scheduler) {
+            // Fibre d'un SwFiberScheduler : elle reprend sur le premier worker disponible
+            yielded.scheduler->wake(yielded.fiber);
+            return;
+        }
+
+        // La fibre reprend sur la boucle qui l'a suspendue, quel que soit le thread appelant
+        SwCoreApplication* owner = yielded.owner;
+        if (owner) {
+            if (yielded.fiber) {
+                std::lock_guard<std::mutex> lock(owner->getReadyMutex());
+                owner->getReadyFibers().push(yielded.fiber);
+            }
+            // unYieldFiber peut venir d'un autre thread : on réveille la boucle si elle dort
+            owner->dispatcher.wakeUp();
         }
     }
 
@@ -687,102 +1023,676 @@ public:
         return positionalArgs;
     }
 
-protected:
-
-    static std::mutex& getYieldMutex() {
-         static std::mutex s_yieldMutex;
-         return s_yieldMutex;
-     }
+    /**
+     * @brief Returns the pool of fibers used to run events and timers.
+     *
+     * The pool can be tuned before or while the loop runs:
+     * ```cpp
+     * app.fiberPool().setWarmSize(64);  // created up front
+     * app.fiberPool().setMaxSize(1024); // idle fibers kept for reuse
+     * SwFiberPool::Stats stats = app.fiberPool().stats(); // hits, misses, live fibers...
+     * ```
+     */
+    SwFiberPool& fiberPool() {
+        return m_fiberPool;
+    }
 
-     static std::map<int, LPVOID>& getYieldedFibers() {
-         static std::map<int, LPVOID> s_yieldedFibers;
-         return s_yieldedFibers;
-     }
+    /**
+     * @brief Returns the fair-share accounting of the runtimes installed on this loop.
+     *
+     * ```cpp
+     * app.runtimeScheduler().setPeriod(50000);     // 50 ms periods
+     * app.runtimeScheduler().setRuntimeShare(0.3); // runtimes get 30% of the loop at most
+     * for (const auto& runtime : app.runtimeScheduler().stats()) { ... }
+     * ```
+     *
+     * @see SwEventLoop::installRuntime, SwEventLoop::installSlowRuntime
+     */
+    SwRuntimeScheduler& runtimeScheduler() {
+        return m_runtimeScheduler;
+    }
 
-     static std::mutex& getReadyMutex() {
-         static std::mutex s_readyMutex;
-         return s_readyMutex;
-     }
+    /**
+     * @brief Limits applied to the batch of posted events drained on each loop iteration.
+     *
+     * Draining several events per iteration amortises the per-iteration cost (clock reads, load
+     * measurement, dispatcher poll). The limits keep timers and ready fibers serviced between
+     * batches.
+     */
+    struct DrainPolicy {
+        int maxEvents = 64;          ///< Maximum number of events per batch, `0` for no limit.
+        int budgetMicroseconds = 0;  ///< Time after which the batch stops, `0` for no budget.
+    };
 
-     static std::queue<LPVOID>& getReadyFibers() {
-         static std::queue<LPVOID> s_readyFibers;
-         return s_readyFibers;
-     }
+    /**
+     * @brief Sets how many posted events are drained per loop iteration.
+     *
+     * ```cpp
+     * app.setDrainPolicy(256, 500); // at most 256 events or 500 us, then timers and fibers
+     * ```
+     *
+     * @param maxEvents Maximum number of events per batch, `0` for no limit.
+     * @param budgetMicroseconds Time budget of a batch, `0` for no budget.
+     *
+     * @warning With neither limit, a producer faster than the loop starves timers and fibers.
+     */
+    void setDrainPolicy(int maxEvents, int budgetMicroseconds = 0) {
+        m_drainPolicy.maxEvents = (std::max)(0, maxEvents);
+        m_drainPolicy.budgetMicroseconds = (std::max)(0, budgetMicroseconds);
+    }
 
-    static void __stdcall trampolineFunction() {
-        instance()->m_runningFiber = nullptr;
-        SwitchToFiber(instance()->mainFiber);
-        // Ne jamais revenir ici
+    /**
+     * @brief Returns the current drain policy.
+     */
+    DrainPolicy drainPolicy() const {
+        return m_drainPolicy;
     }
 
+    /**
+     * @brief How the loop waits when it has nothing to run.
+     */
+    enum class LatencyProfile {
+        Blocking, ///< Sleeps in the dispatcher until a deadline, a post or a descriptor (default).
+        Hybrid,   ///< Busy-polls for a few microseconds, then sleeps.
+        Spin      ///< Never sleeps: busy-polls the queue, the timers and the descriptors.
+    };
 
+    /**
+     * @brief Chooses between reaction time and CPU usage. Safe from any thread, applies to the next wait.
+     *
+     * Sleeping in the kernel costs a context switch and scheduler latency on every wakeup (tens of
+     * microseconds, more under load). Spinning reacts in a few hundred nanoseconds but keeps a
+     * core busy, so `Spin` is meant for a loop pinned on a dedicated core. `Hybrid` spins
+     * `spinMicroseconds` before sleeping, which catches bursts without burning an idle core.
+     *
+     * ```cpp
+     * app.setLatencyProfile(SwCoreApplication::LatencyProfile::Hybrid, 50);
+     * app.setTelemetryEnabled(true);
+     * ...
+     * app.telemetry().wakeupLatency().percentile(99.0); // microseconds
+     * ```
+     *
+     * @param profile The wait strategy.
+     * @param spinMicroseconds Spin duration of `Hybrid` before it sleeps.
+     *
+     * @note Spinning time is not counted as busy in the load figures.
+     */
+    void setLatencyProfile(LatencyProfile profile, int spinMicroseconds = 50) {
+        m_spinMicroseconds.store((std::max)(0, spinMicroseconds));
+        m_latencyProfile.store(static_cast<int>(profile));
+        dispatcher.wakeUp(); // un sommeil en cours reprend avec le nouveau profil
+    }
 
-    void forceBackToMainFiber() {
-        HANDLE hMainThread = OpenThread(THREAD_ALL_ACCESS, FALSE, instance()->mainThreadId);
-        if (!hMainThread) {
-            std::cerr << "OpenThread failed" << std::endl;
-            return;
-        }
+    LatencyProfile latencyProfile() const {
+        return static_cast<LatencyProfile>(m_latencyProfile.load(std::memory_order_relaxed));
+    }
 
-        CONTEXT ctx;
-        ctx.ContextFlags = CONTEXT_FULL;
-        if (SuspendThread(hMainThread) == (DWORD)-1) {
-            std::cerr << "SuspendThread failed: " << GetLastError() << std::endl;
-            CloseHandle(hMainThread);
-            return;
-        }
+    int spinMicroseconds() const {
+        return m_spinMicroseconds.load(std::memory_order_relaxed);
+    }
 
-        if (!GetThreadContext(hMainThread, &ctx)) {
-            std::cerr << "GetThreadContext failed: " << GetLastError() << std::endl;
-            ResumeThread(hMainThread);
-            CloseHandle(hMainThread);
-            return;
+    /**
+     * @brief Queues background work that only runs when the loop has nothing else to do.
+     *
+     * Idle tasks run when the event queue is empty, no fiber is ready and no timer is due within
+     * the idle horizon (see `setIdleHorizon`), so housekeeping (cache trimming, log flushing,
+     * compaction) does not delay the events of the application. A task that has waited past its
+     * deadline runs anyway: then one chunk per loop iteration, among the other events.
+     *
+     * The chunk is called repeatedly while it returns `true`, with the loop free to handle events
+     * between two calls; each call should do a bounded amount of work. Tasks are served in turn,
+     * one chunk each.
+     *
+     * ```cpp
+     * app.postIdleChunkedTask([&cache]() {
+     *     cache.evictSome(64);          // a few entries per call
+     *     return cache.overBudget();    // true: call again when idle
+     * }, 5000);                         // at the latest within 5 s
+     * ```
+     *
+     * @param chunk Work step, returning `true` while there is more to do.
+     * @param deadlineMilliseconds Delay after which the task runs even if the loop is never idle,
+     *        `-1` for none.
+     *
+     * @note Thread-safe. Chunks run in a fiber of this loop and may wait on futures or sockets.
+     */
+    void postIdleChunkedTask(std::function<bool()> chunk, int deadlineMilliseconds = -1) {
+        IdleTask task;
+        task.chunk = std::move(chunk);
+        task.hasDeadline = deadlineMilliseconds >= 0;
+        if (task.hasDeadline) {
+            task.deadline = SwClock::now(clock()) + std::chrono::milliseconds(deadlineMilliseconds);
         }
-
-        // Assurez-vous que ctx.Rsp pointe vers une zone valide, souvent le contexte original contient déjà une valeur de Rsp
-        // On ne modifie que Rip ici par simplicité
-        #if defined(_M_X64) || defined(_WIN64)
-            ctx.Rip = (DWORD64)&SwCoreApplication::trampolineFunction;
-        #elif defined(_M_IX86)
-            ctx.Eip = (DWORD)&SwCoreApplication::trampolineFunction;
-        #else
-            // Ajouter la gestion d'une autre architecture si besoin 
-            // ou au moins un commentaire pour savoir qu'on ne supporte pas
-            // cette architecture par exemple:
-            #error "Architecture non supportée pour la modification du contexte"
-        #endif
-
-        if (!SetThreadContext(hMainThread, &ctx)) {
-            std::cerr << "SetThreadContext failed: " << GetLastError() << std::endl;
+        {
+            std::lock_guard<std::mutex> lock(m_idleMutex);
+            if (task.hasDeadline && task.deadline < m_nextIdleDeadline) {
+                m_nextIdleDeadline = task.deadline;
+            }
+            m_idleTasks.push_back(std::move(task));
+            m_idleTaskCount.fetch_add(1, std::memory_order_release);
         }
-
-        if (ResumeThread(hMainThread) == (DWORD)-1) {
-            std::cerr << "ResumeThread failed: " << GetLastError() << std::endl;
+        if (currentLoop() != this) {
+            dispatcher.wakeUp();
         }
+    }
 
-        CloseHandle(hMainThread);
+    /**
+     * @brief Queues a one-shot background task, see `postIdleChunkedTask`.
+     */
+    void postIdleTask(std::function<void()> task, int deadlineMilliseconds = -1) {
+        postIdleChunkedTask([task]() {
+            task();
+            return false;
+        }, deadlineMilliseconds);
     }
 
+    /**
+     * @brief Sets how far away the next timer must be for idle tasks to start, in microseconds.
+     *
+     * It is also the longest stretch of idle chunks run in a row before the loop checks its
+     * descriptors again. Defaults to 1000 µs.
+     */
+    void setIdleHorizon(int microseconds) {
+        m_idleHorizon = (std::max)(0, microseconds);
+    }
 
-    void watchdogLoop() {
-        using namespace std::chrono;
-        while (watchdogRunning && running) {
-            std::this_thread::sleep_for(milliseconds(5));
-            if (m_runningFiber) {
-                auto now = steady_clock::now();
-                auto elapsed = duration_cast<milliseconds>(now - fiberStartTime).count();
-                if (elapsed > 10 && !fireWatchDog) {
-                    // Fibre bloquante détectée !
-                    fireWatchDog = true;
-                    forceBackToMainFiber();
-                }
-            }
-        }
+    int idleHorizon() const {
+        return m_idleHorizon;
     }
+
     /**
-     * @brief Enables high-precision timers using the Windows multimedia timer.
+     * @brief Returns the number of idle tasks waiting, or being run, on this loop.
      */
-    void enableHighPrecisionTimers() {
+    size_t idleTaskCount() const {
+        return m_idleTaskCount.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief What `postEvent` does when the bounded event queue is full.
+     */
+    enum class OverloadPolicy {
+        Block,      ///< The producer waits for room: a fiber parks, a thread blocks.
+        DropNewest, ///< The new event is discarded.
+        DropOldest, ///< The oldest queued event is discarded at once to make room for the new one.
+        Reject      ///< The new event is refused; the caller handles the `false` result.
+    };
+
+    /**
+     * @brief Overload counters of the event queue.
+     */
+    struct EventQueueStats {
+        size_t depth = 0;         ///< Events queued right now.
+        size_t peakDepth = 0;     ///< Highest depth seen.
+        uint64_t dropped = 0;     ///< Events discarded by `DropNewest` or `DropOldest`.
+        uint64_t rejected = 0;    ///< Events refused by `Reject`.
+        uint64_t blocked = 0;     ///< Posts that had to wait for room (`Block`).
+        bool overloaded = false;  ///< Above the high watermark and not yet back below the low one.
+    };
+
+    /**
+     * @brief Bounds the event queue.
+     *
+     * ```cpp
+     * app.setEventQueueCapacity(100000, SwCoreApplication::OverloadPolicy::Reject);
+     * app.setEventQueueWatermarks(80000, 20000);
+     * ```
+     *
+     * @param capacity Maximum number of queued events, `0` for an unbounded queue (the default).
+     * @param policy What happens to an event posted while the queue is full.
+     *
+     * @note With `Block`, a post made from this loop's own thread is admitted over the capacity:
+     *       waiting there would keep the loop from ever making room. Events posted with
+     *       `postEventUnbounded` are never refused, dropped or blocked. Producers still blocked
+     *       when the loop is destroyed are released and their `postEvent` returns `false`.
+     */
+    void setEventQueueCapacity(size_t capacity, OverloadPolicy policy = OverloadPolicy::Block) {
+        m_eventQueueCapacity.store(capacity);
+        m_overloadPolicy.store(static_cast<int>(policy));
+        if (threadInstance() == this) {
+            syncPopMode(); // sinon le consommateur bascule au prochain lot
+        }
+        wakeBlockedProducers(true);
+    }
+
+    size_t eventQueueCapacity() const {
+        return m_eventQueueCapacity.load();
+    }
+
+    OverloadPolicy overloadPolicy() const {
+        return static_cast<OverloadPolicy>(m_overloadPolicy.load());
+    }
+
+    /**
+     * @brief Sets the depths at which the loop reports itself overloaded, then recovered.
+     *
+     * The loop compares its depth with the watermarks after each batch of events: once it reaches
+     * `high` the overload handlers are called with `true`, and with `false` once it is back to
+     * `low` or below. The gap between the two keeps the state from flapping.
+     *
+     * @param high Depth that starts the overload, `0` to disable the watermarks.
+     * @param low Depth that ends it, lower than `high`.
+     */
+    void setEventQueueWatermarks(size_t high, size_t low) {
+        m_highWatermark = high;
+        m_lowWatermark = (std::min)(low, high > 0 ? high - 1 : 0);
+    }
+
+    /**
+     * @brief Registers a callback told when the loop enters (`true`) or leaves (`false`) overload.
+     *
+     * Callbacks run on the loop thread, between two batches of events, and must not yield. A
+     * component producing work for the loop throttles itself there, e.g. `SwTcpServer` stops
+     * accepting connections until the backlog is drained. Like `removeOverloadHandler`, to be
+     * called on the loop thread; post it there from another thread.
+     *
+     * @return An identifier for `removeOverloadHandler`.
+     */
+    int addOverloadHandler(std::function<void(bool)> handler) {
+        int id = m_nextOverloadHandlerId++;
+        m_overloadHandlers.push_back(std::make_pair(id, std::move(handler)));
+        return id;
+    }
+
+    void removeOverloadHandler(int id) {
+        for (auto it = m_overloadHandlers.begin(); it != m_overloadHandlers.end(); ++it) {
+            if (it->first == id) {
+                m_overloadHandlers.erase(it);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Returns `true` while the loop is between its high and low watermarks.
+     */
+    bool isOverloaded() const {
+        return m_overloaded.load();
+    }
+
+    /**
+     * @brief Returns the number of events queued right now. Safe from any thread.
+     */
+    size_t queuedEventCount() const {
+        return m_queuedEvents.load();
+    }
+
+    EventQueueStats eventQueueStats() const {
+        EventQueueStats stats;
+        stats.depth = m_queuedEvents.load();
+        stats.peakDepth = m_peakQueuedEvents.load();
+        stats.dropped = m_droppedEvents.load();
+        stats.rejected = m_rejectedEvents.load();
+        stats.blocked = m_blockedPosts.load();
+        stats.overloaded = m_overloaded.load();
+        return stats;
+    }
+
+    /**
+     * @brief Installs the clock the timers and fiber sleeps of this loop are scheduled against.
+     *
+     * With a `SwSimulatedClock`, the loop no longer sleeps until its next deadline: once it has
+     * nothing to run, time jumps straight to that deadline. Timeout-heavy scenarios then replay in
+     * CPU time, in the same order as with the real clock.
+     *
+     * ```cpp
+     * SwSimulatedClock clock;
+     * app.setClock(&clock);
+     * ```
+     *
+     * @param clock The clock, not owned, or `nullptr` for `std::chrono::steady_clock`.
+     *
+     * Code running on this loop reads it through `SwClock::now()`. Other loops, including the
+     * loops of a `SwShardedRuntime`, keep their own clock unless `setClock` is called on them too.
+     *
+     * @note Install it before arming timers: deadlines already armed were computed on the
+     *       previous clock. `SwSimulatedClock` starts at the current steady time for that reason.
+     */
+    void setClock(SwClock* clock) {
+        m_clock.store(clock, std::memory_order_release);
+        dispatcher.wakeUp();
+    }
+
+    SwClock* clock() const {
+        return m_clock.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Gives access to the telemetry of this loop (load windows, latency histograms, tags).
+     *
+     * ```cpp
+     * app.setTelemetryEnabled(true);
+     * ...
+     * uint64_t p99 = app.telemetry().queueDelay().percentile(99.0); // microseconds
+     * ```
+     */
+    SwLoopTelemetry& telemetry() {
+        return m_telemetry;
+    }
+
+    /**
+     * @brief Turns on the latency histograms (queueing delay, execution, timer lateness, tags).
+     *
+     * Off by default: when on, each post and each event costs two clock reads.
+     */
+    void setTelemetryEnabled(bool enabled) {
+        m_telemetry.setEnabled(enabled);
+    }
+
+    /**
+     * @brief Applies a real-time profile to the loop thread. Call it from that thread, before `exec()`.
+     *
+     * Sets the scheduling class, locks the memory, pins the thread and touches its stack (see
+     * `SwRealtime::apply`), and chooses how recurring timers are rearmed: with
+     * `fixedRateTimers`, the next deadline is the previous one plus the interval, so a 1 kHz
+     * `SwTimer` fires 1000 times per second instead of drifting by its lateness on each tick;
+     * periods missed entirely are skipped, not fired in a burst.
+     *
+     * ```cpp
+     * SwRealtimeProfile profile;
+     * profile.cpu = 3;                      // isolcpus=3
+     * app.setRealtimeProfile(profile);
+     * app.setJitterMeasurementEnabled(true);
+     * ...
+     * app.timerJitter().percentile(99.9);   // microseconds
+     * ```
+     *
+     * @return `true` if every step succeeded; failures are reported on `std::cerr`.
+     */
+    bool setRealtimeProfile(const SwRealtimeProfile& profile) {
+        m_fixedRateTimers = profile.fixedRateTimers;
+        m_realtimePriority = profile.policy != SwRealtimeProfile::Policy::Normal;
+        return SwRealtime::apply(profile);
+    }
+
+    /**
+     * @brief Records the lateness of every timer firing in `timerJitter()`.
+     *
+     * Lighter than the full telemetry, which also stamps every posted event: a jitter run costs
+     * one clock read per timer firing, so it measures the loop without disturbing it.
+     */
+    void setJitterMeasurementEnabled(bool enabled) {
+        m_measureJitter = enabled;
+    }
+
+    bool isJitterMeasurementEnabled() const {
+        return m_measureJitter;
+    }
+
+    /**
+     * @brief Lateness of the timer firings since the jitter measurement was enabled or reset. Loop thread only.
+     */
+    const SwLatencyHistogram& timerJitter() const {
+        return m_timerJitter;
+    }
+
+    void resetTimerJitter() {
+        m_timerJitter.reset();
+    }
+
+    /**
+     * @brief Number of fibers of this loop in each state.
+     */
+    struct FiberCounts {
+        size_t running = 0;  ///< Executing (the caller, when asked from a fiber).
+        size_t ready = 0;    ///< Waiting in the ready list.
+        size_t sleeping = 0; ///< Parked on the timer heap (`SwEventLoop::swsleep`).
+        size_t parked = 0;   ///< Suspended by `yieldFiber` (futures, channels, sockets, locks...).
+        size_t idle = 0;     ///< Pooled, without a task.
+        size_t live = 0;     ///< Every fiber of the pool.
+    };
+
+    /**
+     * @brief Counts the fibers of this loop by state. Loop thread only.
+     */
+    FiberCounts fiberCounts() {
+        FiberCounts counts;
+        SwFiberPool::Stats pool = m_fiberPool.stats();
+        counts.live = pool.live;
+        counts.idle = pool.idle;
+        counts.running = m_runningFiber ? 1 : 0;
+        counts.sleeping = m_sleepingFibers;
+        {
+            std::lock_guard<std::mutex> lock(getReadyMutex());
+            counts.ready = getReadyFibers().size();
+        }
+        // le reste des fibres occupées attend un unYieldFiber
+        size_t accounted = counts.idle + counts.running + counts.sleeping + counts.ready;
+        counts.parked = counts.live > accounted ? counts.live - accounted : 0;
+        return counts;
+    }
+
+    /**
+     * @brief Exports the state of the loop as JSON: load windows, queue depth and overload
+     *        counters, fiber counts, latency histograms and per-tag timings. Loop thread only.
+     *
+     * Durations are in microseconds, loads in percent.
+     */
+    SwJsonObject telemetrySnapshot() {
+        SwJsonObject json = m_telemetry.toJson();
+        json.insert("loadTotal", getLoadPercentage());
+
+        EventQueueStats queue = eventQueueStats();
+        SwJsonObject queueJson;
+        queueJson.insert("depth", SwLoopTelemetry::jsonCount(queue.depth));
+        queueJson.insert("peakDepth", SwLoopTelemetry::jsonCount(queue.peakDepth));
+        queueJson.insert("capacity", SwLoopTelemetry::jsonCount(eventQueueCapacity()));
+        queueJson.insert("dropped", SwLoopTelemetry::jsonCount(queue.dropped));
+        queueJson.insert("rejected", SwLoopTelemetry::jsonCount(queue.rejected));
+        queueJson.insert("blocked", SwLoopTelemetry::jsonCount(queue.blocked));
+        queueJson.insert("overloaded", queue.overloaded);
+        json.insert("eventQueue", queueJson);
+
+        FiberCounts fibers = fiberCounts();
+        SwJsonObject fibersJson;
+        fibersJson.insert("running", SwLoopTelemetry::jsonCount(fibers.running));
+        fibersJson.insert("ready", SwLoopTelemetry::jsonCount(fibers.ready));
+        fibersJson.insert("sleeping", SwLoopTelemetry::jsonCount(fibers.sleeping));
+        fibersJson.insert("parked", SwLoopTelemetry::jsonCount(fibers.parked));
+        fibersJson.insert("idle", SwLoopTelemetry::jsonCount(fibers.idle));
+        fibersJson.insert("live", SwLoopTelemetry::jsonCount(fibers.live));
+        json.insert("fibers", fibersJson);
+
+        json.insert("timers", SwLoopTelemetry::jsonCount(timers.size()));
+        json.insert("idleTasks", SwLoopTelemetry::jsonCount(idleTaskCount()));
+        if (m_measureJitter) {
+            json.insert("timerJitterUs", SwLoopTelemetry::toJson(m_timerJitter));
+        }
+
+        static const char* const profileNames[] = {"blocking", "hybrid", "spin"};
+        SwJsonObject profileJson;
+        profileJson.insert("mode", profileNames[static_cast<int>(latencyProfile())]);
+        profileJson.insert("spinUs", SwLoopTelemetry::jsonCount(static_cast<uint64_t>(spinMicroseconds())));
+        json.insert("latencyProfile", profileJson);
+        return json;
+    }
+
+    /**
+     * @brief Returns `true` while an inline callback is running on the main context.
+     */
+    bool isRunningInline() const {
+        return inlineDepth > 0;
+    }
+
+protected:
+
+    /**
+     * @brief A fiber suspended by `yieldFiber`, with the loop it must resume on.
+     */
+    struct YieldedFiber {
+        SwFiber* fiber; ///< Suspended fiber, `nullptr` for an inline wait.
+        SwCoreApplication* owner; ///< Event loop that suspended the fiber, `nullptr` for a scheduler task.
+        SwFiberScheduler* scheduler; ///< Scheduler running the fiber, `nullptr` for an event loop fiber.
+        bool prepared; ///< Announced by `prepareYield`, the waiter has not suspended yet.
+        bool woken; ///< `unYieldFiber` arrived while `prepared`.
+    };
+
+    /**
+     * @brief Records the waiter of `id` just before it suspends.
+     * @return `false` if a prepared wait was already woken: the caller must not suspend.
+     */
+    static bool commitYield(int id, const YieldedFiber& waiter) {
+        std::lock_guard<std::mutex> lock(getYieldMutex());
+        auto it = getYieldedFibers().find(id);
+        if (it != getYieldedFibers().end() && it->second.woken) {
+            getYieldedFibers().erase(it);
+            return false;
+        }
+        getYieldedFibers()[id] = waiter;
+        return true;
+    }
+
+    static std::mutex& getYieldMutex() {
+         static std::mutex s_yieldMutex;
+         return s_yieldMutex;
+     }
+
+     static std::unordered_map<int, YieldedFiber>& getYieldedFibers() {
+         static std::unordered_map<int, YieldedFiber> s_yieldedFibers;
+         return s_yieldedFibers;
+     }
+
+     std::mutex& getReadyMutex() {
+         return readyMutex;
+     }
+
+     SwFiberReadyList& getReadyFibers() {
+         return readyFibers;
+     }
+
+    static SwCoreApplication*& threadInstance() {
+        static thread_local SwCoreApplication* s_threadApp = nullptr;
+        return s_threadApp;
+    }
+
+    static SwCoreApplication*& mainInstance() {
+        static SwCoreApplication* s_mainApp = nullptr;
+        return s_mainApp;
+    }
+
+    /**
+     * @brief Makes this object the loop of the calling thread.
+     * @param mainCandidate If `true`, it also becomes the main application when there is none yet.
+     */
+    void registerInstance(bool mainCandidate) {
+        threadInstance() = this;
+        if (mainCandidate && !mainInstance()) {
+            mainInstance() = this;
+        }
+    }
+
+    /**
+     * @brief Constructor used for the secondary loops of `SwShardedRuntime`.
+     *
+     * The loop is bound to the calling thread but never becomes the main application, and no
+     * console handler is installed.
+     */
+    struct SecondaryLoopTag {};
+    explicit SwCoreApplication(SecondaryLoopTag)
+        : running(true), exitCode(0) {
+        registerInstance(false);
+        enableHighPrecisionTimers();
+        initFibers();
+        captureMainThread();
+    }
+
+    /**
+     * @brief Records the thread running this loop, the one the watchdog brings back to its main fiber.
+     */
+    void captureMainThread() {
+#if defined(_WIN32)
+        mainThreadHandle = GetCurrentThread();
+        mainThreadId = GetCurrentThreadId();
+#endif
+    }
+
+#if defined(_WIN32)
+    static void __stdcall trampolineFunction() {
+        instance()->m_runningFiber = nullptr;
+        SwFiber::switchTo(instance()->mainFiber);
+        // Ne jamais revenir ici
+    }
+
+
+
+    void forceBackToMainFiber() {
+        // Appelé depuis le thread du watchdog : instance() y désigne l'application principale, pas cette boucle
+        HANDLE hMainThread = OpenThread(THREAD_ALL_ACCESS, FALSE, mainThreadId);
+        if (!hMainThread) {
+            std::cerr << "OpenThread failed" << std::endl;
+            return;
+        }
+
+        CONTEXT ctx;
+        ctx.ContextFlags = CONTEXT_FULL;
+        if (SuspendThread(hMainThread) == (DWORD)-1) {
+            std::cerr << "SuspendThread failed: " << GetLastError() << std::endl;
+            CloseHandle(hMainThread);
+            return;
+        }
+
+        if (!GetThreadContext(hMainThread, &ctx)) {
+            std::cerr << "GetThreadContext failed: " << GetLastError() << std::endl;
+            ResumeThread(hMainThread);
+            CloseHandle(hMainThread);
+            return;
+        }
+
+        // Assurez-vous que ctx.Rsp pointe vers une zone valide, souvent le contexte original contient déjà une valeur de Rsp
+        // On ne modifie que Rip ici par simplicité
+        #if defined(_M_X64) || defined(_WIN64)
+            ctx.Rip = (DWORD64)&SwCoreApplication::trampolineFunction;
+        #elif defined(_M_IX86)
+            ctx.Eip = (DWORD)&SwCoreApplication::trampolineFunction;
+        #else
+            // Ajouter la gestion d'une autre architecture si besoin 
+            // ou au moins un commentaire pour savoir qu'on ne supporte pas
+            // cette architecture par exemple:
+            #error "Architecture non supportée pour la modification du contexte"
+        #endif
+
+        if (!SetThreadContext(hMainThread, &ctx)) {
+            std::cerr << "SetThreadContext failed: " << GetLastError() << std::endl;
+        }
+
+        if (ResumeThread(hMainThread) == (DWORD)-1) {
+            std::cerr << "ResumeThread failed: " << GetLastError() << std::endl;
+        }
+
+        CloseHandle(hMainThread);
+    }
+#else
+    /**
+     * @brief Rewriting the context of another thread is only implemented on Windows: the blocking fiber is reported.
+     */
+    void forceBackToMainFiber() {
+        std::cerr << "[SwCoreApplication] A fiber has been running for more than 10 ms without yielding." << std::endl;
+    }
+#endif
+
+
+    void watchdogLoop() {
+        using namespace std::chrono;
+        while (watchdogRunning && running) {
+            std::this_thread::sleep_for(milliseconds(5));
+            if (m_runningFiber) {
+                auto now = steady_clock::now();
+                auto elapsed = duration_cast<milliseconds>(now - fiberStartTime).count();
+                if (elapsed > 10 && !fireWatchDog) {
+                    // Fibre bloquante détectée !
+                    fireWatchDog = true;
+                    forceBackToMainFiber();
+                }
+            }
+        }
+    }
+    /**
+     * @brief Enables high-precision timers using the Windows multimedia timer.
+     *
+     * Nothing to do elsewhere: the Linux dispatcher waits on a timerfd with microsecond
+     * resolution (see `SwRealtime::enableHighPrecisionTimers` for the timer slack).
+     */
+    void enableHighPrecisionTimers() {
+#if defined(_WIN32)
         HMODULE hWinMM = LoadLibrary(TEXT("winmm.dll"));
         if (hWinMM) {
             auto timeBeginPeriodFunc = (MMRESULT(WINAPI*)(UINT))GetProcAddress(hWinMM, "timeBeginPeriod");
@@ -794,12 +1704,14 @@ protected:
             }
             FreeLibrary(hWinMM);
         }
+#endif
     }
 
     /**
      * @brief Disables high-precision timers using the Windows multimedia timer.
      */
     void disableHighPrecisionTimers() {
+#if defined(_WIN32)
         HMODULE hWinMM = LoadLibrary(TEXT("winmm.dll"));
         if (hWinMM) {
             auto timeEndPeriodFunc = (MMRESULT(WINAPI*)(UINT))GetProcAddress(hWinMM, "timeEndPeriod");
@@ -808,14 +1720,19 @@ protected:
             }
             FreeLibrary(hWinMM);
         }
+#endif
     }
 
     /**
      * @brief Sets a high thread priority for the current thread.
+     *
+     * Windows only: raising the priority of a Linux thread needs privileges, see `setRealtimeProfile`.
      */
     void setHighThreadPriority() {
+#if defined(_WIN32)
         HANDLE thread = GetCurrentThread();
         SetThreadPriority(thread, THREAD_PRIORITY_HIGHEST);
+#endif
     }
 
     /**
@@ -860,60 +1777,30 @@ protected:
     }
 
     /**
-     * @brief Converts the main thread to a fiber.
+     * @brief Converts the main thread to a fiber and pre-creates the pooled fibers.
      *
      * If the conversion fails, an error message is printed.
      */
     void initFibers() {
-        mainFiber = ConvertThreadToFiber(nullptr);
-        if (!mainFiber) {
-            std::cerr << "Failed to convert main thread to fiber. Error: " << GetLastError() << std::endl;
-        }
-    }
-
-    /**
-     * @brief Entry point for a newly created fiber.
-     *
-     * Executes the function passed as a parameter to the fiber and
-     * switches back to the main fiber upon completion.
-     *
-     * @param lpParameter Pointer to the function to execute within the fiber.
-     */
-    static VOID WINAPI FiberProc(LPVOID lpParameter) {
-        std::function<void()>* callback = reinterpret_cast<std::function<void()>*>(lpParameter);
-
-        // Execute the callback function. Once we return from this function call,
-        // we know that the callback has fully completed its execution, including
-        // any yields that might have occurred during its lifetime.
-        (*callback)();
-
-        // At this point, the callback is guaranteed to have finished, so we can
-        // safely delete the allocated std::function. By managing the lifetime
-        // here, we ensure that the callback's memory is only freed after it
-        // truly completes, preventing the risk of double deletes or accessing
-        // deallocated memory if it had simply yielded instead of fully returning.
-        delete callback;
-        instance()->m_runningFiber = nullptr;
-        // Finally, return control to the main fiber.
-        SwitchToFiber(instance()->mainFiber);
+        mainFiber = SwFiber::convertCurrentThread();
+        m_fiberPool.warmUp();
     }
 
-
     /**
      * @brief Executes a given event (function) within a fiber and manages its lifecycle.
      *
-     * This function creates a new fiber to execute the provided event (function), switches
-     * to the fiber to run it, and ensures proper cleanup of the fiber after execution.
+     * This function takes a fiber from the pool to execute the provided event (function), switches
+     * to the fiber to run it, and gives the fiber back to the pool once the event has returned.
      *
      * Steps:
-     * 1. Allocates a new fiber with `CreateFiber` and passes the event function as a parameter.
-     * 2. Switches to the newly created fiber using `SwitchToFiber` to execute the event.
-     * 3. After execution or yielding, the function ensures the fiber is properly deleted
-     *    using `deleteFiberIfNeeded`.
+     * 1. Acquires an idle fiber from `SwFiberPool` (a new one is created only on a pool miss).
+     * 2. Hands it the event and switches to it with `SwFiber::switchTo`.
+     * 3. After execution or yielding, recycles the fiber with `recycleFiberIfFinished` if its
+     *    event has returned.
      *
      * @param event The function to execute within the fiber.
      *
-     * @note If fiber creation fails, the event is executed synchronously in the current thread,
+     * @note If no fiber can be created, the event is executed synchronously in the current thread,
      *       and the function logs an error message.
      *
      * @warning The caller must ensure that the event does not hold any references to objects
@@ -924,18 +1811,17 @@ protected:
      * @remarks Fibers are a cooperative multitasking construct, so the event is expected to
      *          yield or complete its execution without blocking other operations indefinitely.
      */
-    void runEventInFiber(const std::function<void()>& event) {
+    void runEventInFiber(std::function<void()> event) {
         auto startBusy = std::chrono::steady_clock::now();
-        std::function<void()>* cbPtr = new std::function<void()>(event);
-        LPVOID newFiber = CreateFiber(0, FiberProc, cbPtr);
-        if (!newFiber) {
-            std::cerr << "Failed to create fiber. Error: " << GetLastError() << "\n";
-            (*cbPtr)();
-            delete cbPtr;
+        SwFiber* fiber = m_fiberPool.acquire();
+        if (!fiber) {
+            std::cerr << "Failed to create fiber, running the event synchronously.\n";
+            event();
             return;
         }
-        
-        safeRunningFiber(newFiber);
+
+        fiber->setTask(std::move(event));
+        safeRunningFiber(fiber);
 
         // Calcul du temps occupé dans cette opération
         auto endBusy = std::chrono::steady_clock::now();
@@ -946,49 +1832,39 @@ protected:
     /**
      * @brief Resumes fibers that are ready to run.
      *
-     * This function processes the queue of ready fibers (`s_readyFibers`) and resumes their execution
-     * one by one using `SwitchToFiber`. Each fiber is executed until it either completes or yields
+     * This function processes the list of ready fibers (`readyFibers`) and resumes their execution
+     * one by one using `SwFiber::switchTo`. Each fiber is executed until it either completes or yields
      * again. The function ensures that no fiber is resumed more than once during the same cycle.
      *
      * The function follows these steps:
-     * 1. Retrieves a fiber from the `s_readyFibers` queue.
-     * 2. Checks if the fiber has already been resumed during the current cycle using `resumedThisCycle`.
-     *    - If it has, the fiber is requeued, and the function exits to avoid infinite loops.
-     * 3. If the fiber has not been resumed, it is marked as resumed and executed using `SwitchToFiber`.
-     * 4. After execution, checks if the fiber needs to be deleted using `deleteFiberIfNeeded`.
+     * 1. Reads how many fibers are ready when the cycle starts.
+     * 2. Pops and resumes that many fibers at most. A fiber that becomes ready again during the
+     *    cycle (it called `release()`, or was woken by another fiber) is appended behind them and
+     *    waits for the next cycle, which avoids infinite loops.
+     * 3. After execution, gives the fiber back to the pool if its event has returned.
      *
      * @note This function uses thread safety mechanisms (mutex locks) to ensure consistent access
-     *       to the `s_readyFibers` queue.
+     *       to the `readyFibers` list.
      *
-     * @note A fiber that has already been resumed in the current cycle is requeued for execution
-     *       in subsequent cycles of the event loop.
+     * @note The ready list is intrusive and the fiber state is kept in the fiber, so a cycle does
+     *       not allocate, whatever the number of ready or sleeping fibers.
      */
     void resumeReadyFibers() {
-        std::unordered_set<LPVOID> resumedThisCycle;
         auto startBusy = std::chrono::steady_clock::now();
-        while (true) {
-            LPVOID fiber = nullptr;
+        size_t budget = 0;
+        {
+            std::lock_guard<std::mutex> lock(getReadyMutex());
+            budget = getReadyFibers().size();
+        }
+        while (budget-- > 0) {
+            SwFiber* fiber = nullptr;
             {
                 std::lock_guard<std::mutex> lock(getReadyMutex());
-                if (!getReadyFibers().empty()) {
-                    fiber = getReadyFibers().front();
-                    getReadyFibers().pop();
-                } else {
-                    break; // No more fibers to resume
-                }
+                fiber = getReadyFibers().pop();
             }
-
-            // Check if the fiber has already been resumed during this cycle
-            if (resumedThisCycle.find(fiber) != resumedThisCycle.end()) {
-                // Fiber has already been executed this cycle, requeue it for later
-                {
-                    std::lock_guard<std::mutex> lock(getReadyMutex());
-                    getReadyFibers().push(fiber);
-                }
-                // Exit this cycle; the fiber will be retried in the next processEvent() call.
-                break;
+            if (!fiber) {
+                break; // No more fibers to resume
             }
-            resumedThisCycle.insert(fiber);
             safeRunningFiber(fiber);
         }
         // Calcul du temps occupé dans cette opération
@@ -997,164 +1873,934 @@ protected:
         busyElapsedIteration += (uint64_t)busyElapsed;
     }
 
-    void safeRunningFiber(LPVOID _fiber)
+    void safeRunningFiber(SwFiber* _fiber)
     {
         if (!_fiber) {
             return;
         }
 
         m_runningFiber = _fiber;
-        SwitchToFiber(_fiber);
+        fiberStartTime = std::chrono::steady_clock::now();
+        SwFiber::switchTo(_fiber);
+        m_runningFiber = nullptr;
+        if (void* runtime = _fiber->userData()) {
+            // Fibre d'un runtime installé : la tranche est décomptée de son budget
+            auto slice = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - fiberStartTime).count();
+            m_runtimeScheduler.charge(static_cast<SwRuntimeScheduler::Runtime*>(runtime), slice);
+        }
         if(fireWatchDog)
         {
             std::lock_guard<std::mutex> lock(getReadyMutex());
             fireWatchDog = false;
-            instance()->getReadyFibers().push(_fiber);
+            getReadyFibers().push(_fiber);
         }
         // Back here after the fiber finishes or yields again
-        // Check if the fiber needs to be deleted
-        deleteFiberIfNeeded(_fiber);
+        recycleFiberIfFinished(_fiber);
     }
 
     /**
-     * @brief Deletes a fiber if it is no longer in use.
+     * @brief Gives a fiber back to the pool once its event has returned.
      *
-     * This function checks whether a given fiber is still being used, either as a yielded fiber
-     * (waiting to be resumed) or as a ready fiber (waiting to be executed). If the fiber is neither
-     * yielded nor ready, it is safely deleted.
+     * A fiber that yielded (its state is `Yielded` or `Ready`) has not finished its event and is
+     * left untouched. This is an O(1) check on the fiber state.
      *
-     * The function performs the following steps:
-     * 1. Checks if the fiber is present in the `s_yieldedFibers` map (yielded fibers).
-     * 2. If not yielded, checks if the fiber is present in the `s_readyFibers` queue (ready fibers).
-     * 3. If the fiber is neither yielded nor ready, calls `DeleteFiber` to release its resources.
+     * @param fiber Pointer to the fiber to check and potentially recycle.
+     */
+    void recycleFiberIfFinished(SwFiber* fiber) {
+        if (fiber == mainFiber) {
+            return;
+        }
+        if (fiber->isFinished()) {
+            m_fiberPool.recycle(fiber);
+        }
+    }
+
+    /**
+     * @brief Runs a callback directly on the main context (`ExecutionHint::Inline`).
      *
-     * @param fiber Pointer to the fiber to check and potentially delete.
+     * @return `true` if the callback tried to yield while running, in which case its source
+     *         should use a fiber from now on.
+     */
+    template<typename Callable>
+    bool runEventInline(Callable&& event) {
+        auto startBusy = std::chrono::steady_clock::now();
+        bool outerDetected = inlineYieldDetected;
+        inlineYieldDetected = false;
+        ++inlineDepth;
+        event();
+        --inlineDepth;
+        bool yielded = inlineYieldDetected;
+        inlineYieldDetected = outerDetected || yielded;
+
+        auto endBusy = std::chrono::steady_clock::now();
+        busyElapsedIteration += (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(endBusy - startBusy).count();
+        return yielded;
+    }
+
+    /**
+     * @brief Serves a `yieldFiber(id)` issued by an inline callback.
      *
-     * @note The function ensures thread safety by using mutex locks when accessing the shared
-     *       `s_yieldedFibers` and `s_readyFibers` data structures.
-     * @note If the fiber is still in use, it is not deleted.
-     */    
-    void deleteFiberIfNeeded(void* fiber) {
-        if(fiber == instance()->mainFiber){
+     * The main context cannot be parked, so the loop keeps turning from here until
+     * `unYieldFiber(id)` is called or the application quits.
+     */
+    void waitInline(int id) {
+        if (!commitYield(id, YieldedFiber{nullptr, this, nullptr, false, false})) {
             return;
         }
+        while (running) {
+            {
+                std::lock_guard<std::mutex> lock(getYieldMutex());
+                if (getYieldedFibers().find(id) == getYieldedFibers().end()) {
+                    return;
+                }
+            }
+            waitForEvents(processEvent());
+        }
+        std::lock_guard<std::mutex> lock(getYieldMutex());
+        getYieldedFibers().erase(id);
+    }
 
-        bool fiberYielded = isFiberYielded(fiber);
-        bool fiberReady = !fiberYielded && isFiberReady(fiber);
+    /**
+     * @brief Background work queued by `postIdleChunkedTask`.
+     */
+    struct IdleTask {
+        std::function<bool()> chunk; ///< Returns `true` while there is more to do.
+        bool hasDeadline = false;
+        std::chrono::steady_clock::time_point deadline; ///< Runs anyway once reached.
+    };
+
+    /**
+     * @brief Runs idle task chunks: one overdue chunk, then as many as fit while the loop stays idle.
+     *
+     * The loop counts as idle when `hasImmediateWork()` is `false` and the next timer or fiber
+     * sleep is more than `m_idleHorizon` away. The clock is read again after each chunk, so work
+     * posted meanwhile stops the pass at the next chunk boundary. A pass lasts at most the horizon.
+     *
+     * @return `true` if idle tasks remain.
+     */
+    bool processIdleTasks() {
+        if (idleTaskCount() == 0) {
+            return false;
+        }
+        IdleTask task;
+        auto now = SwClock::now(clock());
+        if (takeOverdueIdleTask(now, task)) {
+            runIdleTask(std::move(task)); // affamée : elle passe au rang des événements ordinaires
+        }
+
+        const auto passStart = std::chrono::steady_clock::now();
+        const auto horizon = std::chrono::microseconds(m_idleHorizon);
+        while (isIdleFor(horizon) && takeIdleTask(task)) {
+            runIdleTask(std::move(task));
+            if (std::chrono::steady_clock::now() - passStart >= horizon) {
+                break; // les descripteurs seront sondés avant la passe suivante
+            }
+        }
+        return idleTaskCount() > 0;
+    }
 
-        if (!fiberYielded && !fiberReady) {
-            DeleteFiber(fiber);
+    /**
+     * @brief Returns `true` if nothing is pending and no timer is due within `horizon`.
+     */
+    bool isIdleFor(std::chrono::microseconds horizon) {
+        if (hasImmediateWork()) {
+            return false;
         }
+        std::chrono::steady_clock::time_point deadline;
+        return !nextTimerDeadline(deadline) || deadline - SwClock::now(clock()) > horizon;
     }
 
+    bool hasQueuedIdleTasks() {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        return !m_idleTasks.empty();
+    }
 
-    bool isFiberYielded(LPVOID fiber) {
-        std::lock_guard<std::mutex> lock(getYieldMutex());
-        for (auto &kv : getYieldedFibers()) {
-            if (kv.second == fiber) {
+    bool takeIdleTask(IdleTask& task) {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        if (m_idleTasks.empty()) {
+            return false;
+        }
+        task = std::move(m_idleTasks.front());
+        m_idleTasks.pop_front();
+        if (task.hasDeadline && task.deadline == m_nextIdleDeadline) {
+            updateNextIdleDeadline();
+        }
+        return true;
+    }
+
+    bool takeOverdueIdleTask(const std::chrono::steady_clock::time_point& now, IdleTask& task) {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        if (now < m_nextIdleDeadline) {
+            return false;
+        }
+        for (auto it = m_idleTasks.begin(); it != m_idleTasks.end(); ++it) {
+            if (it->hasDeadline && it->deadline <= now) {
+                task = std::move(*it);
+                m_idleTasks.erase(it);
+                updateNextIdleDeadline();
                 return true;
             }
         }
+        updateNextIdleDeadline();
         return false;
     }
 
-    bool isFiberReady(LPVOID fiber) {
-        std::lock_guard<std::mutex> lock(getReadyMutex());
-        std::queue<LPVOID> temp = getReadyFibers();
-        while (!temp.empty()) {
-            LPVOID f = temp.front();
-            temp.pop();
-            if (f == fiber) {
-                return true;
+    /**
+     * @brief Recomputes `m_nextIdleDeadline`. Called with `m_idleMutex` held.
+     */
+    void updateNextIdleDeadline() {
+        m_nextIdleDeadline = (std::chrono::steady_clock::time_point::max)();
+        for (const IdleTask& queued : m_idleTasks) {
+            if (queued.hasDeadline && queued.deadline < m_nextIdleDeadline) {
+                m_nextIdleDeadline = queued.deadline;
             }
         }
-        return false;
+    }
+
+    /**
+     * @brief Runs one chunk of `task` in a fiber; the task goes back to the end of the queue while it returns `true`.
+     */
+    void runIdleTask(IdleTask&& task) {
+        // La tâche fait l'aller-retour file -> fibre -> file par déplacements, sans copie
+        std::shared_ptr<IdleTask> shared = std::make_shared<IdleTask>(std::move(task));
+        runEventInFiber([this, shared]() {
+            if (shared->chunk()) {
+                std::lock_guard<std::mutex> lock(m_idleMutex);
+                if (shared->hasDeadline && shared->deadline < m_nextIdleDeadline) {
+                    m_nextIdleDeadline = shared->deadline;
+                }
+                m_idleTasks.push_back(std::move(*shared));
+            } else {
+                m_idleTaskCount.fetch_sub(1, std::memory_order_release);
+            }
+        });
+    }
+
+    /**
+     * @brief Time until the earliest idle task deadline, `0` if one is overdue.
+     */
+    int timeUntilIdleDeadline(const std::chrono::steady_clock::time_point& now) {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        if (m_nextIdleDeadline == (std::chrono::steady_clock::time_point::max)()) {
+            return (std::numeric_limits<int>::max)();
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(m_nextIdleDeadline - now).count();
+        if (remaining <= 0) {
+            return 0;
+        }
+        return static_cast<int>((std::min)(remaining, static_cast<decltype(remaining)>((std::numeric_limits<int>::max)() - 1)));
+    }
+
+    /**
+     * @brief Computes the next deadline of a recurring timer that fired at `deadline`, during the pass at `now`.
+     */
+    void rearmTimer(_T* timer, std::chrono::steady_clock::time_point deadline, std::chrono::steady_clock::time_point now) {
+        const std::chrono::microseconds interval(timer->interval);
+        if (!m_fixedRateTimers || interval.count() <= 0) {
+            timer->deadline = now + interval;
+            return;
+        }
+        timer->deadline = deadline + interval;
+        if (timer->deadline <= now) {
+            // Périodes entièrement manquées : on saute à la prochaine échéance du rythme
+            timer->deadline += interval * ((now - timer->deadline) / interval + 1);
+        }
     }
 
     /**
      * @brief Processes timers, executing callbacks for ready timers, and calculates the time
      *        until the next timer is ready.
      *
-     * This function iterates through a list of timers, executes the callbacks for those that are ready,
-     * and determines the minimum time remaining until the next timer becomes ready.
+     * Only due timers are visited: entries are popped from the deadline heap until the earliest
+     * remaining deadline lies in the future, and the clock is read once for the whole pass.
+     * Recurring timers are rearmed `interval` microseconds after this pass (after their deadline
+     * with fixed-rate timers) and pushed back only once the pass is over, so a zero-interval timer
+     * runs once per loop iteration.
      *
-     * @param timers Map of timers where the key is the timer ID and the value is a pointer to the timer object.
      * @return The time in microseconds until the next timer is ready, or the maximum possible integer
      *         if no timers are active.
      */
     int processTimers() {
-        int minTimeUntilNext = (std::numeric_limits<int>::max)();
+        const auto now = SwClock::now(clock());
+        // Un callback inline qui attend relance la boucle : la passe imbriquée travaille après `base`
+        const size_t base = rearmedTimers.size();
+
+        while (!timerHeap.isEmpty()) {
+            const SwTimerHeap::Entry entry = timerHeap.top();
+            if (entry.timerId == SwTimerHeap::SleeperId) {
+                if (entry.deadline > now) {
+                    break;
+                }
+                // Fibre endormie par sleepFiberUntil : elle rejoint directement la liste des prêtes
+                timerHeap.pop();
+                --m_sleepingFibers;
+                if (m_wokeFromIdle && m_telemetry.isEnabled()) {
+                    m_telemetry.recordWakeup(static_cast<uint64_t>((std::max)(int64_t(0), static_cast<int64_t>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(SwClock::now(clock()) - entry.deadline).count()))));
+                    m_wokeFromIdle = false;
+                }
+                std::lock_guard<std::mutex> lock(getReadyMutex());
+                getReadyFibers().push(static_cast<SwFiber*>(entry.sleeper));
+                continue;
+            }
+            auto it = timers.find(entry.timerId);
+            if (it == timers.end() || it->second->scheduleOrder != entry.order) {
+                timerHeap.pop(); // entrée périmée : timer arrêté ou réarmé
+                continue;
+            }
+            if (!it->second->isReady(now)) {
+                break;
+            }
+            timerHeap.pop();
 
-        for (auto it = timers.begin(); it != timers.end(); ) {
             _T* currentTimer = it->second;
-            bool isSingleShot = currentTimer->singleShot;
-
-            if (currentTimer->isReady()) {
-                // Timer is ready to execute
-                if (isSingleShot) {
-                    // Remove and delete single-shot timer after execution
-                    _T* toDelete = currentTimer;
-                    it = timers.erase(it);  // Advance the iterator after removal
-
-                    // Execute timer callback in a fiber
-                    std::function<void()> timerEvent = [toDelete]() {
-                        toDelete->execute();
-                        delete toDelete; // Delete the timer after execution
-                    };
-                    runEventInFiber(timerEvent);
-                } else {
-                    // Execute recurring timer without removing it
-                    std::function<void()> timerEvent = [currentTimer]() {
-                        currentTimer->execute();
-                    };
-                    runEventInFiber(timerEvent);
+            if (currentTimer->singleShot) {
+                // Remove single-shot timer, it is deleted once its callback has returned
+                timers.erase(it);
+                currentTimer->cancelled = true;
+            } else {
+                rearmTimer(currentTimer, entry.deadline, now);
+                rearmedTimers.push_back(std::make_pair(entry.timerId, currentTimer));
+            }
+
+            if (m_measureJitter) {
+                m_timerJitter.record(static_cast<uint64_t>((std::max)(int64_t(0), static_cast<int64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(SwClock::now(clock()) - entry.deadline).count()))));
+            }
+
+            const bool measured = m_telemetry.isEnabled();
+            int64_t startUs = 0;
+            if (measured) {
+                uint64_t lateness = static_cast<uint64_t>((std::max)(int64_t(0), static_cast<int64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(SwClock::now(clock()) - entry.deadline).count())));
+                m_telemetry.recordTimerLateness(lateness);
+                if (m_wokeFromIdle) {
+                    m_telemetry.recordWakeup(lateness);
+                    m_wokeFromIdle = false;
+                }
+                startUs = SwLoopTelemetry::nowMicroseconds();
+            }
+            const char* tag = currentTimer->telemetryTag;
+
+            ++currentTimer->activeCalls;
+            if (currentTimer->executionHint == ExecutionHint::Inline) {
+                // Exécution directe ; si le callback a cédé la main, les prochains ticks passent en fibre
+                if (runEventInline([currentTimer]() { currentTimer->execute(); })) {
+                    currentTimer->executionHint = ExecutionHint::Fiber;
+                }
+                --currentTimer->activeCalls;
+                if (currentTimer->cancelled && currentTimer->activeCalls == 0) {
+                    delete currentTimer;
+                }
+                if (measured && tag) {
+                    m_telemetry.recordTagged(static_cast<uint64_t>(SwLoopTelemetry::nowMicroseconds() - startUs), tag);
+                }
+                continue;
+            }
+
+            // Execute timer callback in a fiber
+            std::function<void()> timerEvent = [this, currentTimer]() {
+                currentTimer->execute();
+                --currentTimer->activeCalls;
+                if (currentTimer->cancelled && currentTimer->activeCalls == 0) {
+                    delete currentTimer;
+                }
+            };
+            runEventInFiber(timerEvent);
+            if (measured && tag) {
+                m_telemetry.recordTagged(static_cast<uint64_t>(SwLoopTelemetry::nowMicroseconds() - startUs), tag);
+            }
+        }
+
+        for (size_t i = base; i < rearmedTimers.size(); ++i) {
+            auto it = timers.find(rearmedTimers[i].first);
+            if (it != timers.end() && it->second == rearmedTimers[i].second) {
+                pushTimerEntry(rearmedTimers[i].first, rearmedTimers[i].second);
+            }
+        }
+        rearmedTimers.resize(base);
+
+        // Purge stale entries once they dominate the heap
+        if (timerHeap.size() > 2 * timers.size() + 1024) {
+            timerHeap.compact([this](const SwTimerHeap::Entry& entry) {
+                if (entry.timerId == SwTimerHeap::SleeperId) {
+                    return false;
+                }
+                auto it = timers.find(entry.timerId);
+                return it == timers.end() || it->second->scheduleOrder != entry.order;
+            });
+        }
+
+        return timeUntilNextTimer(now);
+    }
+
+    /**
+     * @brief Returns the time in microseconds until the earliest live heap entry is due.
+     *
+     * Stale entries found at the top of the heap are discarded on the way.
+     *
+     * @return The remaining time, `0` if the entry is already due, or the maximum possible integer
+     *         if no timer is armed and no fiber sleeps.
+     */
+    int timeUntilNextTimer(const std::chrono::steady_clock::time_point& now) {
+        std::chrono::steady_clock::time_point deadline;
+        if (!nextTimerDeadline(deadline)) {
+            return (std::numeric_limits<int>::max)();
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+        if (remaining <= 0) {
+            return 0;
+        }
+        // au-delà de ~35 min l'entier déborderait : on se réveillera avant et on recalculera
+        return static_cast<int>((std::min)(remaining, static_cast<decltype(remaining)>((std::numeric_limits<int>::max)() - 1)));
+    }
+
+    /**
+     * @brief Reads the deadline of the earliest live heap entry (timer or sleeping fiber).
+     *
+     * Stale entries found at the top of the heap are discarded on the way.
+     *
+     * @return `false` if no timer is armed and no fiber sleeps.
+     */
+    bool nextTimerDeadline(std::chrono::steady_clock::time_point& deadline) {
+        while (!timerHeap.isEmpty()) {
+            const SwTimerHeap::Entry& entry = timerHeap.top();
+            if (entry.timerId == SwTimerHeap::SleeperId) {
+                deadline = entry.deadline;
+                return true;
+            }
+            auto it = timers.find(entry.timerId);
+            if (it != timers.end() && it->second->scheduleOrder == entry.order) {
+                deadline = entry.deadline;
+                return true;
+            }
+            timerHeap.pop();
+        }
+        return false;
+    }
+
+    /**
+     * @brief With a simulated clock, jumps to the next deadline instead of waiting for it.
+     *
+     * Only done when the loop has nothing to run right now; with nothing scheduled the loop still
+     * blocks for real, waiting for a post from another thread or a descriptor.
+     *
+     * @return `true` if the clock was advanced.
+     */
+    bool advanceSimulatedClock() {
+        SwClock* clock = this->clock();
+        if (!clock || !clock->isSimulated() || hasImmediateWork()) {
+            return false;
+        }
+        std::chrono::steady_clock::time_point deadline;
+        if (!nextTimerDeadline(deadline)) {
+            return false;
+        }
+        clock->advanceTo(deadline);
+        return true;
+    }
+
+    /**
+     * @brief Pushes the current deadline of a timer into the heap.
+     *
+     * Any entry previously pushed for this timer becomes stale.
+     */
+    void pushTimerEntry(int timerId, _T* timer) {
+        timer->scheduleOrder = ++timerScheduleOrder;
+        SwTimerHeap::Entry entry = { timer->deadline, timer->scheduleOrder, timerId, nullptr };
+        timerHeap.push(entry);
+    }
+
+    /**
+     * @brief Deletes a removed timer, or defers the deletion while one of its callbacks is running.
+     */
+    void releaseTimer(_T* timer) {
+        timer->cancelled = true;
+        if (timer->activeCalls == 0) {
+            delete timer;
+        }
+    }
+
+    /**
+     * @brief Returns `true` if the event queue holds at least one event.
+     */
+    bool hasQueuedEvents() {
+        return m_keptEventCount.load(std::memory_order_acquire) > 0 || !eventQueue.isEmpty();
+    }
+
+    /**
+     * @brief Runs a batch of posted events, each in its own fiber, within the limits of `policy`.
+     *
+     * Nodes are popped one at a time from the lock-free queue. An event posted while the batch
+     * is running may be picked up by the same batch. The budget is checked after each event, so
+     * a batch overruns it by at most one event.
+     *
+     * @return The number of events that were started.
+     */
+    int processQueuedEvents(const DrainPolicy& policy) {
+        const bool hasBudget = policy.budgetMicroseconds > 0;
+        std::chrono::steady_clock::time_point budgetEnd;
+        if (hasBudget) {
+            budgetEnd = std::chrono::steady_clock::now() + std::chrono::microseconds(policy.budgetMicroseconds);
+        }
 
-                    ++it; // Advance the iterator
+        syncPopMode();
+        int processed = 0;
+        while (policy.maxEvents <= 0 || processed < policy.maxEvents) {
+            if (hasBudget && processed > 0 && std::chrono::steady_clock::now() >= budgetEnd) {
+                break;
+            }
+            SwEventQueue::Node* node = popEvent();
+            if (!node) {
+                break;
+            }
+            ++processed;
+            eventDequeued();
+            const unsigned int flags = SwEventQueue::flags(node);
+            // horodaté par pushEvent quand la télémétrie est active
+            const int64_t stamp = SwEventQueue::stamp(node);
+            const char* tag = SwEventQueue::tag(node);
+            int64_t startUs = 0;
+            if (stamp != 0) {
+                startUs = SwLoopTelemetry::nowMicroseconds();
+                uint64_t delay = static_cast<uint64_t>((std::max)(int64_t(0), startUs - stamp));
+                m_telemetry.recordQueueDelay(delay);
+                if (m_wokeFromIdle) {
+                    m_telemetry.recordWakeup(delay); // premier événement après une attente
+                    m_wokeFromIdle = false;
                 }
+            }
+            if (flags & InlineEventFlag) {
+                runEventInline([node]() { SwEventQueue::run(node); });
+                SwEventQueue::release(node);
             } else {
-                // Calculate time until the next timer is ready
-                int timeUntilNext = currentTimer->timeUntilReady();
-                if (timeUntilNext < minTimeUntilNext) {
-                    minTimeUntilNext = timeUntilNext;
+                // le nœud est rendu au pool une fois l'événement terminé, même s'il a cédé la main
+                runEventInFiber([node]() {
+                    SwEventQueue::run(node);
+                    SwEventQueue::release(node);
+                });
+            }
+            if (stamp != 0) {
+                m_telemetry.recordExecution(static_cast<uint64_t>(SwLoopTelemetry::nowMicroseconds() - startUs), tag);
+            }
+        }
+        updateOverloadState();
+        return processed;
+    }
+
+    /**
+     * @brief Counts a posted event in the depth and pushes it.
+     */
+    template<typename Callable>
+    void pushEvent(Callable&& event, unsigned int flags) {
+        size_t depth = m_queuedEvents.fetch_add(1) + 1;
+        size_t peak = m_peakQueuedEvents.load(std::memory_order_relaxed);
+        while (depth > peak && !m_peakQueuedEvents.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {
+        }
+        if (m_telemetry.isEnabled()) {
+            eventQueue.push(std::forward<Callable>(event), flags, SwLoopTelemetry::nowMicroseconds(), SwLoopTelemetry::currentTag());
+        } else {
+            eventQueue.push(std::forward<Callable>(event), flags);
+        }
+        dispatcher.wakeUp();
+    }
+
+    /**
+     * @brief Applies the overload policy to an event about to be posted.
+     * @return `false` if the event must not be queued.
+     */
+    bool admitEvent() {
+        if (hasQueueRoom()) {
+            return true;
+        }
+        switch (static_cast<OverloadPolicy>(m_overloadPolicy.load(std::memory_order_relaxed))) {
+        case OverloadPolicy::DropNewest:
+            ++m_droppedEvents;
+            return false;
+        case OverloadPolicy::Reject:
+            ++m_rejectedEvents;
+            return false;
+        case OverloadPolicy::DropOldest:
+            return dropOldestEvent();
+        case OverloadPolicy::Block:
+        default:
+            return waitForQueueRoom();
+        }
+    }
+
+    /**
+     * @brief Returns `true` if the queue is unbounded or holds fewer live events than its capacity.
+     */
+    bool hasQueueRoom() const {
+        size_t capacity = m_eventQueueCapacity.load();
+        if (capacity == 0) {
+            return true;
+        }
+        return m_queuedEvents.load() < capacity;
+    }
+
+    /**
+     * @brief Switches the pops of the loop to the mutex while `DropOldest` is the policy. Loop thread only.
+     *
+     * Producers only discard events once the loop itself has made the switch, so a pop of the loop
+     * never runs concurrently with theirs.
+     */
+    void syncPopMode() {
+        bool locked = static_cast<OverloadPolicy>(m_overloadPolicy.load(std::memory_order_relaxed)) == OverloadPolicy::DropOldest;
+        if (locked != m_lockedPops) {
+            std::lock_guard<std::mutex> lock(m_consumerMutex);
+            m_lockedPops = locked;
+        }
+    }
+
+    /**
+     * @brief Pops the oldest queued event. Loop thread only.
+     *
+     * Without `DropOldest` this is the plain lock-free pop. Otherwise the mutex is shared with the
+     * producers discarding events, and the events they had to set aside come first.
+     */
+    SwEventQueue::Node* popEvent() {
+        if (!m_lockedPops && m_keptEventCount.load(std::memory_order_relaxed) == 0) {
+            return eventQueue.pop();
+        }
+        std::lock_guard<std::mutex> lock(m_consumerMutex);
+        if (!m_keptEvents.empty()) {
+            SwEventQueue::Node* node = m_keptEvents.front();
+            m_keptEvents.pop_front();
+            m_keptEventCount.store(m_keptEvents.size(), std::memory_order_release);
+            return node;
+        }
+        return eventQueue.pop();
+    }
+
+    /**
+     * @brief Makes room for a new event by discarding the oldest queued one (`DropOldest`).
+     *
+     * The discard happens at once, from the posting thread, so the depth never goes above the
+     * capacity. Events posted with `postEventUnbounded` are never discarded: they are set aside,
+     * in order, and still run before anything else.
+     *
+     * @return `false` if no event could be discarded (the loop has not switched to locked pops yet,
+     *         or a concurrent push is still being linked): the new event is dropped instead.
+     */
+    bool dropOldestEvent() {
+        SwEventQueue::Node* victim = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_consumerMutex);
+            if (!m_lockedPops) {
+                ++m_droppedEvents;
+                return false;
+            }
+            while (SwEventQueue::Node* node = eventQueue.pop()) {
+                if (!(SwEventQueue::flags(node) & UnboundedEventFlag)) {
+                    victim = node;
+                    break;
+                }
+                m_keptEvents.push_back(node);
+            }
+            m_keptEventCount.store(m_keptEvents.size(), std::memory_order_release);
+        }
+        ++m_droppedEvents;
+        if (!victim) {
+            dispatcher.wakeUp(); // les événements mis de côté doivent tout de même être vus
+            return false;
+        }
+        SwEventQueue::release(victim);
+        eventDequeued();
+        return true;
+    }
+
+    /**
+     * @brief Parks the posting fiber, or blocks the posting thread, until the queue has room.
+     * @return `false` if the loop is being destroyed: the event must not be pushed.
+     */
+    bool waitForQueueRoom() {
+        if (currentLoop() == this) {
+            return true; // attendre ici empêcherait la boucle de vider sa propre queue
+        }
+        ++m_blockedPosts;
+        std::unique_lock<std::mutex> lock(m_queueRoomMutex);
+        if (m_shuttingDown) {
+            return false;
+        }
+        m_blockedProducers.fetch_add(1);
+        while (!hasQueueRoom() && !m_shuttingDown) {
+            if (canYield()) {
+                int yieldId = generateYieldId();
+                prepareYield(yieldId);
+                m_blockedFiberIds.push_back(yieldId);
+                lock.unlock();
+                yieldFiber(yieldId);
+                lock.lock();
+            } else {
+                m_queueRoom.wait(lock);
+            }
+        }
+        m_blockedProducers.fetch_sub(1);
+        if (m_shuttingDown) {
+            // Le destructeur attend le départ du dernier producteur ; this n'est plus touché ensuite
+            m_queueRoom.notify_all();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Called by the destructor: wakes the blocked producers, which then refuse their event,
+     *        and waits until none of them uses the loop any more.
+     */
+    void releaseBlockedProducers() {
+        {
+            std::lock_guard<std::mutex> lock(m_queueRoomMutex);
+            m_shuttingDown = true;
+        }
+        wakeBlockedProducers(true);
+        std::unique_lock<std::mutex> lock(m_queueRoomMutex);
+        m_queueRoom.wait(lock, [this]() { return m_blockedProducers.load() == 0; });
+    }
+
+    /**
+     * @brief Resumes producers blocked by `OverloadPolicy::Block`: one of each kind when a slot
+     *        frees up, all of them when `all` is set (the capacity changed).
+     */
+    void wakeBlockedProducers(bool all) {
+        if (m_blockedProducers.load() == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_queueRoomMutex);
+        if (all) {
+            m_queueRoom.notify_all();
+            for (int yieldId : m_blockedFiberIds) {
+                unYieldFiber(yieldId);
+            }
+            m_blockedFiberIds.clear();
+            return;
+        }
+        if (!hasQueueRoom()) {
+            return;
+        }
+        m_queueRoom.notify_one();
+        if (!m_blockedFiberIds.empty()) {
+            unYieldFiber(m_blockedFiberIds.front());
+            m_blockedFiberIds.pop_front();
+        }
+    }
+
+    /**
+     * @brief Accounts for a popped event and lets a blocked producer in.
+     */
+    void eventDequeued() {
+        m_queuedEvents.fetch_sub(1);
+        wakeBlockedProducers(false);
+    }
+
+    /**
+     * @brief Compares the depth with the watermarks and calls the overload handlers on a change.
+     */
+    void updateOverloadState() {
+        bool overloaded = m_overloaded.load(std::memory_order_relaxed);
+        size_t depth = m_queuedEvents.load();
+        if (!overloaded && m_highWatermark > 0 && depth >= m_highWatermark) {
+            overloaded = true;
+        } else if (overloaded && (m_highWatermark == 0 || depth <= m_lowWatermark)) {
+            overloaded = false;
+        } else {
+            return;
+        }
+        m_overloaded.store(overloaded);
+        // copie : un gestionnaire peut se retirer pendant l'appel
+        std::vector<std::pair<int, std::function<void(bool)>>> handlers = m_overloadHandlers;
+        for (auto& handler : handlers) {
+            handler.second(overloaded);
+        }
+    }
+
+    /**
+     * @brief Returns `true` if the loop has something to run right now and must not block.
+     */
+    bool hasImmediateWork() {
+        if (!running || hasQueuedEvents()) {
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(getReadyMutex());
+        return !getReadyFibers().isEmpty();
+    }
+
+    /**
+     * @brief Blocks in the dispatcher, then runs the callbacks of the descriptors reported ready.
+     *
+     * @param timeoutMicroseconds Maximum time to block, `0` to only poll descriptors, `-1` to
+     *        block until an event is posted or a descriptor becomes ready.
+     */
+    void waitForEvents(int timeoutMicroseconds) {
+        if (advanceSimulatedClock()) {
+            timeoutMicroseconds = 0; // le temps a sauté : on ne fait que sonder les descripteurs
+        }
+        if (timeoutMicroseconds != 0 && latencyProfile() != LatencyProfile::Blocking
+            && spinForWork(timeoutMicroseconds)) {
+            return;
+        }
+        if (timeoutMicroseconds != 0) {
+            dispatcher.prepareWait();
+            if (hasImmediateWork()) {
+                dispatcher.cancelWait();
+                timeoutMicroseconds = 0;
+            } else {
+                m_wokeFromIdle = true;
+            }
+        }
+        if (timeoutMicroseconds == 0 && !dispatcher.hasDescriptors()) {
+            return;
+        }
+
+        dispatcher.waitForEvents(timeoutMicroseconds, readyDescriptors);
+        dispatchReadyDescriptors();
+    }
+
+    /**
+     * @brief Busy-polls for work instead of sleeping (`LatencyProfile::Spin` and `Hybrid`).
+     *
+     * Each round only reads atomics (the event queue and the ready-fiber count) and pauses the
+     * CPU; no mutex is taken. The descriptors, when some are registered, are polled with a
+     * non-blocking dispatcher wait every `DescriptorPollMicroseconds`, not on every round.
+     *
+     * @param timeoutMicroseconds Time until the next deadline (`-1` for none). When the spin
+     *        budget of `Hybrid` runs out first, it is reduced by the time spent spinning.
+     * @return `true` if work showed up or the deadline passed, `false` if the loop must now sleep.
+     */
+    bool spinForWork(int& timeoutMicroseconds) {
+        if (hasImmediateWork()) {
+            return true;
+        }
+        m_wokeFromIdle = true;
+        const auto start = std::chrono::steady_clock::now();
+        long long nextPoll = 0;
+        while (true) {
+            const LatencyProfile profile = latencyProfile();
+            if (!running || hasQueuedEvents() || !getReadyFibers().isEmptyHint()) {
+                return true;
+            }
+            long long elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            if (elapsed >= nextPoll) {
+                nextPoll = elapsed + DescriptorPollMicroseconds;
+                if (dispatcher.hasDescriptors()) {
+                    dispatcher.waitForEvents(0, readyDescriptors);
+                    if (!readyDescriptors.empty()) {
+                        dispatchReadyDescriptors();
+                        return true;
+                    }
                 }
-                ++it;
             }
+            if (timeoutMicroseconds > 0 && elapsed >= timeoutMicroseconds) {
+                return true;
+            }
+            if (profile != LatencyProfile::Spin && elapsed >= spinMicroseconds()) {
+                if (timeoutMicroseconds > 0) {
+                    timeoutMicroseconds -= static_cast<int>(elapsed);
+                }
+                return false;
+            }
+            cpuRelax();
         }
+    }
 
-        return minTimeUntilNext;
+    /**
+     * @brief Hints the CPU that the thread is spinning (`pause` on x86, `yield` on ARM).
+     */
+    static void cpuRelax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+        __yield();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#endif
     }
 
+    /**
+     * @brief Runs, each in a fiber, the callbacks of the descriptors left in `readyDescriptors`.
+     */
+    void dispatchReadyDescriptors() {
+        for (const SwEventDispatcher::ReadyDescriptor& ready : readyDescriptors) {
+            std::function<void(int)> callback = dispatcher.callback(ready.id);
+            if (!callback) {
+                continue; // désenregistré entre-temps
+            }
+            int events = ready.events;
+            runEventInFiber([callback, events]() {
+                callback(events);
+            });
+        }
+    }
 
     /**
      * @brief Retrieves the currently running fiber.
      * @return Pointer to the currently running fiber.
      */
-    LPVOID getRunningFiber() {
+    SwFiber* getRunningFiber() {
         return m_runningFiber;
     }
 
 protected:
-    bool running; ///< Indicates if the event loop is running.
+    std::atomic<bool> running; ///< Indicates if the event loop is running.
     int exitCode; ///< Exit code of the application.
+#if defined(_WIN32)
     HANDLE mainThreadHandle;
     DWORD mainThreadId;
+#endif
 
     std::thread watchdogThread;
     bool watchdogRunning = false;
     bool  fireWatchDog = false;
     std::chrono::steady_clock::time_point fiberStartTime;
 
-    std::queue<std::function<void()>> eventQueue; ///< Queue of events to process.
-    std::mutex eventQueueMutex; ///< Mutex protecting access to the event queue.
-    std::condition_variable cv; ///< Condition variable for event waiting.
-
-    struct IterationMeasurement {
-        std::chrono::steady_clock::time_point timestamp;
-        uint64_t busyMicroseconds;
-        uint64_t totalMicroseconds;
-    };
-    // Queue des mesures sur la dernière seconde environ
-    std::deque<IterationMeasurement> measurements;
+    static const unsigned int InlineEventFlag = 1u; ///< `SwEventQueue` flag of events posted with `ExecutionHint::Inline`.
+    SwEventQueue eventQueue; ///< Lock-free queue of posted events.
+    DrainPolicy m_drainPolicy; ///< Limits of the batch of posted events run per loop iteration.
+    static const unsigned int UnboundedEventFlag = 2u; ///< `SwEventQueue` flag of events posted with `postEventUnbounded`.
+    static const int DescriptorPollMicroseconds = 5; ///< Interval between two descriptor polls of `spinForWork`.
+    std::atomic<size_t> m_queuedEvents{0}; ///< Events pushed and not yet popped.
+    std::atomic<size_t> m_peakQueuedEvents{0}; ///< Highest `m_queuedEvents` seen.
+    std::atomic<size_t> m_eventQueueCapacity{0}; ///< Bound of the queue, `0` when unbounded.
+    std::atomic<int> m_overloadPolicy{static_cast<int>(OverloadPolicy::Block)}; ///< `OverloadPolicy` applied when full.
+    std::mutex m_consumerMutex; ///< Serializes the pops of the loop and of the `DropOldest` producers.
+    std::deque<SwEventQueue::Node*> m_keptEvents; ///< Unbounded events set aside by a `DropOldest` discard.
+    std::atomic<size_t> m_keptEventCount{0}; ///< Size of `m_keptEvents`, readable without the mutex.
+    bool m_lockedPops = false; ///< The loop pops under `m_consumerMutex`; written by the loop under the mutex.
+    std::atomic<uint64_t> m_droppedEvents{0};
+    std::atomic<uint64_t> m_rejectedEvents{0};
+    std::atomic<uint64_t> m_blockedPosts{0};
+    std::atomic<int> m_blockedProducers{0}; ///< Producers waiting for room, read on each pop.
+    std::mutex m_queueRoomMutex; ///< Protects the blocked producers.
+    std::condition_variable m_queueRoom; ///< Blocks the threads waiting for room.
+    std::deque<int> m_blockedFiberIds; ///< Yield identifiers of the fibers waiting for room.
+    bool m_shuttingDown = false; ///< Set by the destructor under `m_queueRoomMutex`; blocked posts then fail.
+    size_t m_highWatermark = 0; ///< Depth that starts an overload, `0` when disabled.
+    size_t m_lowWatermark = 0; ///< Depth that ends it.
+    std::atomic<bool> m_overloaded{false}; ///< Between the watermarks, see `isOverloaded()`.
+    std::vector<std::pair<int, std::function<void(bool)>>> m_overloadHandlers; ///< Told of overload changes.
+    int m_nextOverloadHandlerId = 0;
+    SwEventDispatcher dispatcher; ///< Reactor the loop blocks on when idle.
+    std::vector<SwEventDispatcher::ReadyDescriptor> readyDescriptors; ///< Scratch buffer reused by `waitForEvents`.
+
+    SwLoopTelemetry m_telemetry; ///< Load windows and latency histograms of this loop.
+    std::atomic<int> m_latencyProfile{static_cast<int>(LatencyProfile::Blocking)}; ///< `LatencyProfile` of the waits.
+    std::atomic<int> m_spinMicroseconds{50}; ///< Spin budget of `LatencyProfile::Hybrid`.
+    bool m_wokeFromIdle = false; ///< The loop waited (slept or spun); the next callback measures the wakeup.
+    bool m_fixedRateTimers = false; ///< Recurring timers are rearmed from their deadline (`SwRealtimeProfile`).
+    bool m_realtimePriority = false; ///< A real-time scheduling class was applied; `exec()` keeps it.
+    bool m_measureJitter = false; ///< Timer lateness is recorded in `m_timerJitter`.
+    SwLatencyHistogram m_timerJitter; ///< Lateness of the timer firings, in microseconds.
+    size_t m_sleepingFibers = 0; ///< Fibers parked on the timer heap by `sleepFiberUntil`.
+
+    std::mutex m_idleMutex; ///< Protects the idle tasks, posted from any thread.
+    std::deque<IdleTask> m_idleTasks; ///< Served in turn, one chunk each.
+    std::chrono::steady_clock::time_point m_nextIdleDeadline = (std::chrono::steady_clock::time_point::max)(); ///< Earliest deadline in `m_idleTasks`.
+    std::atomic<size_t> m_idleTaskCount{0}; ///< Queued tasks plus chunks being run.
+    int m_idleHorizon = 1000; ///< Free time required before the next timer, in microseconds.
+    std::atomic<SwClock*> m_clock{nullptr}; ///< Clock of this loop, `nullptr` for the steady clock.
 
     uint64_t totalBusyTimeMicroseconds = 0;
     uint64_t totalTimeMicroseconds = 0;
@@ -1163,14 +2809,51 @@ protected:
     // pour accumuler le temps occupé dans la fibre sur l'itération en cours.
     uint64_t busyElapsedIteration = 0;
 
-    int nextTimerId = 0; ///< Identifier for the next timer to be created.
-    std::map<int, _T*> timers; ///< Map associating timer IDs with their respective _T objects.
+    std::atomic<int> nextTimerId{0}; ///< Identifier for the next timer to be created.
+    std::unordered_map<int, _T*> timers; ///< Map associating timer IDs with their respective _T objects.
+    SwTimerHeap timerHeap; ///< Deadlines of the armed timers, earliest first.
+    uint64_t timerScheduleOrder = 0; ///< Monotonic counter stamped on each heap entry.
+    std::vector<std::pair<int, _T*>> rearmedTimers; ///< Recurring timers fired during the current pass.
     SwMap<SwString, SwString> parsedArguments; ///< Parsed command-line arguments.
 
-    LPVOID m_runningFiber = nullptr; ///< Pointer to the currently running fiber.
-    LPVOID mainFiber = nullptr; ///< Pointer to the main fiber.
+    SwFiberPool m_fiberPool; ///< Idle fibers reused to run events and timers.
+    SwFiber* m_runningFiber = nullptr; ///< Pointer to the currently running fiber.
+    SwRuntimeScheduler m_runtimeScheduler; ///< Budgets of the runtimes installed on this loop.
+    SwFiber* mainFiber = nullptr; ///< Pointer to the main fiber.
+    std::mutex readyMutex; ///< Protects `readyFibers`, fed by `unYieldFiber` from any thread.
+    SwFiberReadyList readyFibers; ///< Fibers of this loop waiting to be resumed (intrusive, allocation-free).
+    int inlineDepth = 0; ///< Number of nested inline callbacks running on the main context.
+    bool inlineYieldDetected = false; ///< Set when the running inline callback tries to yield.
 };
 
+inline void SwFiberScheduler::releaseParkedJobs() {
+    std::vector<SwFiber*> parked;
+    {
+        std::lock_guard<std::mutex> lock(SwCoreApplication::getYieldMutex());
+        auto& yielded = SwCoreApplication::getYieldedFibers();
+        for (auto it = yielded.begin(); it != yielded.end(); ) {
+            if (it->second.scheduler == this) {
+                parked.push_back(it->second.fiber);
+                it = yielded.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (SwFiber* fiber : parked) {
+        dropJob(static_cast<Job*>(fiber->userData()));
+    }
+}
+
+inline SwClock::TimePoint SwClock::now() {
+    return now(current());
+}
+
+inline SwClock* SwClock::current() {
+    SwCoreApplication* loop = SwCoreApplication::currentLoop();
+    return loop ? loop->clock() : nullptr;
+}
+
 /**
  * @brief Handles console control events.
  *
@@ -1186,6 +2869,7 @@ protected:
  *                 - `CTRL_SHUTDOWN_EVENT`: System shutdown.
  * @return BOOL Returns `TRUE` if the event was successfully handled, otherwise `FALSE`.
  */
+#if defined(_WIN32)
 static BOOL WINAPI ConsoleHandler(DWORD ctrlType) {
     switch (ctrlType) {
     case CTRL_CLOSE_EVENT:
@@ -1207,3 +2891,4 @@ static BOOL WINAPI ConsoleHandler(DWORD ctrlType) {
         return FALSE;
     }
 }
+#endif
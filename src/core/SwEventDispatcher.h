@@ -0,0 +1,470 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <iostream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+
+#if defined(_WIN32)
+    #define SW_DISPATCHER_WIN32
+    #include <windows.h>
+#elif defined(__linux__)
+    #define SW_DISPATCHER_EPOLL
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/timerfd.h>
+    #include <unistd.h>
+    #include <errno.h>
+    #include <string.h>
+#endif
+
+
+/**
+ * @class SwEventDispatcher
+ * @brief Blocking reactor used by `SwCoreApplication` to sleep until something actually happens.
+ *
+ * The dispatcher owns the platform primitive the event loop blocks on when it has nothing to do.
+ * The loop wakes up when one of the following happens:
+ * - the next timer deadline is reached (the timeout passed to `waitForEvents`),
+ * - another thread posts an event (`wakeUp`),
+ * - a registered descriptor becomes ready.
+ *
+ * ### Backends:
+ * - **Linux**: `epoll_wait` on an epoll set containing an `eventfd` (cross-thread wake-ups), a
+ *   `timerfd` (microsecond-precise deadlines) and every registered file descriptor.
+ * - **Windows**: `MsgWaitForMultipleObjects` on an auto-reset event (wake-ups) and every registered
+ *   waitable `HANDLE` (for example a `WSAEVENT` bound with `WSAEventSelect`). Window messages
+ *   also wake the loop.
+ * - **Other platforms**: a condition variable, without descriptor support.
+ *
+ * ### Wake-up protocol:
+ * The loop calls `prepareWait()`, re-checks its queues, then calls `waitForEvents()` (or
+ * `cancelWait()` if work showed up in between). `wakeUp()` only touches the kernel when the loop
+ * announced that it is about to block, so posting to a busy loop stays a plain atomic exchange.
+ *
+ * @note Descriptors are level-triggered: a callback must consume the readiness (read the data,
+ *       reset the event, ...) or it will be reported again on the next iteration.
+ */
+class SwEventDispatcher {
+public:
+    /**
+     * @brief Readiness conditions a descriptor can be watched for.
+     */
+    enum DescriptorEvent {
+        ReadEvent  = 0x1, ///< Data available (or waitable object signaled on Windows).
+        WriteEvent = 0x2, ///< Descriptor writable (Linux only).
+        ErrorEvent = 0x4  ///< Error or hang-up reported by the kernel.
+    };
+
+#if defined(SW_DISPATCHER_WIN32)
+    typedef HANDLE Descriptor;
+#else
+    typedef int Descriptor;
+#endif
+
+    typedef std::function<void(int)> DescriptorCallback;
+
+    /**
+     * @brief A descriptor reported ready by `waitForEvents`.
+     */
+    struct ReadyDescriptor {
+        int id;     ///< Registration identifier returned by `registerDescriptor`.
+        int events; ///< Combination of `DescriptorEvent` flags.
+    };
+
+    SwEventDispatcher() {
+#if defined(SW_DISPATCHER_WIN32)
+        m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!m_wakeEvent) {
+            std::cerr << "[SwEventDispatcher] CreateEvent failed: " << GetLastError() << std::endl;
+        }
+#elif defined(SW_DISPATCHER_EPOLL)
+        m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+        m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (m_epollFd < 0 || m_wakeFd < 0 || m_timerFd < 0) {
+            std::cerr << "[SwEventDispatcher] epoll/eventfd/timerfd setup failed: " << strerror(errno) << std::endl;
+            return;
+        }
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u64 = WakeId;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+        ev.data.u64 = TimerId;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_timerFd, &ev);
+#endif
+    }
+
+    ~SwEventDispatcher() {
+#if defined(SW_DISPATCHER_WIN32)
+        if (m_wakeEvent) {
+            CloseHandle(m_wakeEvent);
+        }
+#elif defined(SW_DISPATCHER_EPOLL)
+        if (m_timerFd >= 0) ::close(m_timerFd);
+        if (m_wakeFd >= 0) ::close(m_wakeFd);
+        if (m_epollFd >= 0) ::close(m_epollFd);
+#endif
+    }
+
+    SwEventDispatcher(const SwEventDispatcher&) = delete;
+    SwEventDispatcher& operator=(const SwEventDispatcher&) = delete;
+
+    /**
+     * @brief Returns `true` if the platform primitives were created successfully.
+     */
+    bool isValid() const {
+#if defined(SW_DISPATCHER_WIN32)
+        return m_wakeEvent != nullptr;
+#elif defined(SW_DISPATCHER_EPOLL)
+        return m_epollFd >= 0 && m_wakeFd >= 0 && m_timerFd >= 0;
+#else
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Starts watching a descriptor.
+     *
+     * @param descriptor File descriptor (Linux) or waitable handle (Windows).
+     * @param events Combination of `DescriptorEvent` flags to watch for.
+     * @param callback Invoked by the event loop with the ready flags.
+     * @return A registration identifier, or `-1` on failure.
+     */
+    int registerDescriptor(Descriptor descriptor, int events, DescriptorCallback callback) {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        int id = m_nextId++;
+#if defined(SW_DISPATCHER_WIN32)
+        if (m_registrations.size() == MaxWaitedRegistrations) {
+            // Les handles au-delà de la limite sont sondés sans attente à chaque itération.
+            std::cerr << "[SwEventDispatcher] More than " << MaxWaitedRegistrations
+                      << " handles registered, extra handles will be polled." << std::endl;
+        }
+        m_waitSetDirty = true;
+#elif defined(SW_DISPATCHER_EPOLL)
+        epoll_event ev;
+        ev.events = toEpollEvents(events);
+        ev.data.u64 = static_cast<uint64_t>(id);
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, descriptor, &ev) != 0) {
+            std::cerr << "[SwEventDispatcher] epoll_ctl(ADD) failed: " << strerror(errno) << std::endl;
+            return -1;
+        }
+#else
+        std::cerr << "[SwEventDispatcher] Descriptor watching is not supported on this platform." << std::endl;
+        return -1;
+#endif
+        Registration registration;
+        registration.descriptor = descriptor;
+        registration.events = events;
+        registration.callback = std::move(callback);
+        m_registrations[id] = std::move(registration);
+        return id;
+    }
+
+    /**
+     * @brief Changes the readiness conditions watched for an existing registration.
+     * @return `true` on success.
+     */
+    bool updateDescriptor(int id, int events) {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        auto it = m_registrations.find(id);
+        if (it == m_registrations.end()) {
+            return false;
+        }
+#if defined(SW_DISPATCHER_EPOLL)
+        epoll_event ev;
+        ev.events = toEpollEvents(events);
+        ev.data.u64 = static_cast<uint64_t>(id);
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, it->second.descriptor, &ev) != 0) {
+            std::cerr << "[SwEventDispatcher] epoll_ctl(MOD) failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+#endif
+        it->second.events = events;
+        return true;
+    }
+
+    /**
+     * @brief Stops watching a descriptor. The descriptor itself is not closed.
+     */
+    void unregisterDescriptor(int id) {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        auto it = m_registrations.find(id);
+        if (it == m_registrations.end()) {
+            return;
+        }
+#if defined(SW_DISPATCHER_EPOLL)
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, it->second.descriptor, nullptr);
+#elif defined(SW_DISPATCHER_WIN32)
+        m_waitSetDirty = true;
+#endif
+        m_registrations.erase(it);
+    }
+
+    /**
+     * @brief Returns `true` if at least one descriptor is registered.
+     */
+    bool hasDescriptors() const {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        return !m_registrations.empty();
+    }
+
+    /**
+     * @brief Returns a copy of the callback bound to a registration, or an empty function if the
+     *        registration was removed in the meantime.
+     */
+    DescriptorCallback callback(int id) const {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        auto it = m_registrations.find(id);
+        return it != m_registrations.end() ? it->second.callback : DescriptorCallback();
+    }
+
+    /**
+     * @brief Announces that the loop is about to block. Must be followed by `waitForEvents` or
+     *        `cancelWait`.
+     */
+    void prepareWait() {
+        m_waiting.store(true);
+    }
+
+    /**
+     * @brief Cancels a `prepareWait` because work arrived before the loop blocked.
+     */
+    void cancelWait() {
+        m_waiting.store(false);
+    }
+
+    /**
+     * @brief Wakes the loop if it is blocked (or about to block) in `waitForEvents`.
+     *
+     * Safe to call from any thread. When the loop is running, this is a single atomic exchange.
+     */
+    void wakeUp() {
+        if (!m_waiting.exchange(false)) {
+            return;
+        }
+#if defined(SW_DISPATCHER_WIN32)
+        SetEvent(m_wakeEvent);
+#elif defined(SW_DISPATCHER_EPOLL)
+        uint64_t one = 1;
+        ssize_t written = ::write(m_wakeFd, &one, sizeof(one));
+        (void)written;
+#else
+        {
+            std::lock_guard<std::mutex> lock(m_fallbackMutex);
+            m_fallbackSignaled = true;
+        }
+        m_fallbackCv.notify_one();
+#endif
+    }
+
+    /**
+     * @brief Blocks until a descriptor is ready, `wakeUp()` is called or the timeout expires.
+     *
+     * @param timeoutMicroseconds Maximum time to block, `0` to only poll, `-1` to block without limit.
+     * @param ready Filled with the descriptors reported ready (cleared first).
+     * @return The number of ready descriptors.
+     */
+    int waitForEvents(int timeoutMicroseconds, std::vector<ReadyDescriptor>& ready) {
+        ready.clear();
+#if defined(SW_DISPATCHER_WIN32)
+        rebuildWaitSet();
+        const std::vector<HANDLE>& handles = m_waitHandles;
+        const std::vector<int>& ids = m_waitIds;
+        const std::vector<std::pair<int, HANDLE>>& overflow = m_overflow;
+
+        // WaitForMultipleObjects a une résolution de la milliseconde : arrondi au-dessus, pour ne
+        // pas se réveiller avant l'échéance et tourner à vide jusqu'à elle.
+        DWORD timeoutMs = INFINITE;
+        if (timeoutMicroseconds >= 0) {
+            timeoutMs = (static_cast<DWORD>(timeoutMicroseconds) + 999) / 1000;
+        }
+        if (!overflow.empty() && (timeoutMs == INFINITE || timeoutMs > 1)) {
+            timeoutMs = 1;
+        }
+
+        DWORD result = MsgWaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(),
+                                                 FALSE, timeoutMs, QS_ALLINPUT);
+        m_waiting.store(false);
+        if (result == WAIT_FAILED) {
+            std::cerr << "[SwEventDispatcher] MsgWaitForMultipleObjects failed: " << GetLastError() << std::endl;
+            return 0;
+        }
+
+        // Le premier handle signalé est rapporté, les suivants sont sondés sans attente.
+        DWORD first = (result >= WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + handles.size())
+                ? result - WAIT_OBJECT_0 : static_cast<DWORD>(handles.size());
+        for (size_t i = 1; i < handles.size(); ++i) {
+            if (i == first || (i > first && WaitForSingleObject(handles[i], 0) == WAIT_OBJECT_0)) {
+                ReadyDescriptor r = { ids[i - 1], ReadEvent };
+                ready.push_back(r);
+            }
+        }
+        for (auto& entry : overflow) {
+            if (WaitForSingleObject(entry.second, 0) == WAIT_OBJECT_0) {
+                ReadyDescriptor r = { entry.first, ReadEvent };
+                ready.push_back(r);
+            }
+        }
+#elif defined(SW_DISPATCHER_EPOLL)
+        int timeoutMs = -1;
+        if (timeoutMicroseconds == 0) {
+            timeoutMs = 0;
+        } else if (timeoutMicroseconds > 0) {
+            // Le timerfd porte l'échéance à la microseconde près, epoll_wait n'a qu'une résolution en ms.
+            itimerspec spec = {};
+            spec.it_value.tv_sec = timeoutMicroseconds / 1000000;
+            spec.it_value.tv_nsec = static_cast<long>(timeoutMicroseconds % 1000000) * 1000;
+            timerfd_settime(m_timerFd, 0, &spec, nullptr);
+            m_timerArmed = true;
+        }
+
+        epoll_event events[MaxEventsPerWait];
+        int count = epoll_wait(m_epollFd, events, MaxEventsPerWait, timeoutMs);
+        m_waiting.store(false);
+        if (count < 0) {
+            if (errno != EINTR) {
+                std::cerr << "[SwEventDispatcher] epoll_wait failed: " << strerror(errno) << std::endl;
+            }
+            count = 0;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            uint64_t id = events[i].data.u64;
+            if (id == WakeId) {
+                uint64_t value = 0;
+                ssize_t readBytes = ::read(m_wakeFd, &value, sizeof(value));
+                (void)readBytes;
+            } else if (id == TimerId) {
+                uint64_t expirations = 0;
+                ssize_t readBytes = ::read(m_timerFd, &expirations, sizeof(expirations));
+                (void)readBytes;
+                m_timerArmed = false;
+            } else {
+                ReadyDescriptor r = { static_cast<int>(id), fromEpollEvents(events[i].events) };
+                ready.push_back(r);
+            }
+        }
+
+        if (m_timerArmed) {
+            // Réveil anticipé : on désarme pour ne pas recevoir une expiration périmée plus tard.
+            itimerspec disarm = {};
+            timerfd_settime(m_timerFd, 0, &disarm, nullptr);
+            m_timerArmed = false;
+        }
+#else
+        std::unique_lock<std::mutex> lock(m_fallbackMutex);
+        if (!m_fallbackSignaled && timeoutMicroseconds != 0) {
+            if (timeoutMicroseconds < 0) {
+                m_fallbackCv.wait(lock, [this]() { return m_fallbackSignaled; });
+            } else {
+                m_fallbackCv.wait_for(lock, std::chrono::microseconds(timeoutMicroseconds),
+                                      [this]() { return m_fallbackSignaled; });
+            }
+        }
+        m_fallbackSignaled = false;
+        m_waiting.store(false);
+#endif
+        return static_cast<int>(ready.size());
+    }
+
+private:
+    struct Registration {
+        Descriptor descriptor;
+        int events;
+        DescriptorCallback callback;
+    };
+
+#if defined(SW_DISPATCHER_EPOLL)
+    enum : uint64_t {
+        WakeId = 0xFFFFFFFFFFFFFFFEull,
+        TimerId = 0xFFFFFFFFFFFFFFFFull
+    };
+    static const int MaxEventsPerWait = 64;
+
+    static uint32_t toEpollEvents(int events) {
+        uint32_t result = 0;
+        if (events & ReadEvent) result |= EPOLLIN;
+        if (events & WriteEvent) result |= EPOLLOUT;
+        return result;
+    }
+
+    static int fromEpollEvents(uint32_t events) {
+        int result = 0;
+        if (events & (EPOLLIN | EPOLLPRI)) result |= ReadEvent;
+        if (events & EPOLLOUT) result |= WriteEvent;
+        if (events & (EPOLLERR | EPOLLHUP)) result |= ErrorEvent;
+        return result;
+    }
+
+    int m_epollFd = -1;  ///< Epoll instance the loop blocks on.
+    int m_wakeFd = -1;   ///< eventfd written by `wakeUp`.
+    int m_timerFd = -1;  ///< timerfd carrying the next timer deadline.
+    bool m_timerArmed = false;
+#elif defined(SW_DISPATCHER_WIN32)
+    /// `MsgWaitForMultipleObjects` takes at most `MAXIMUM_WAIT_OBJECTS - 1` handles, the wake event included.
+    enum : size_t { MaxWaitedRegistrations = MAXIMUM_WAIT_OBJECTS - 2 };
+
+    /**
+     * @brief Rebuilds the handle arrays passed to the wait, only after a registration changed. Loop thread only.
+     */
+    void rebuildWaitSet() {
+        std::lock_guard<std::mutex> lock(m_registrationMutex);
+        if (!m_waitSetDirty) {
+            return;
+        }
+        m_waitSetDirty = false;
+        m_waitHandles.clear();
+        m_waitIds.clear();
+        m_overflow.clear();
+        m_waitHandles.push_back(m_wakeEvent);
+        for (auto it = m_registrations.begin(); it != m_registrations.end(); ++it) {
+            if (m_waitIds.size() < MaxWaitedRegistrations) {
+                m_waitHandles.push_back(it->second.descriptor);
+                m_waitIds.push_back(it->first);
+            } else {
+                m_overflow.push_back(std::make_pair(it->first, it->second.descriptor));
+            }
+        }
+    }
+
+    HANDLE m_wakeEvent = nullptr; ///< Auto-reset event signaled by `wakeUp`.
+    bool m_waitSetDirty = true; ///< Registrations changed since the last `rebuildWaitSet`, guarded by `m_registrationMutex`.
+    std::vector<HANDLE> m_waitHandles; ///< Wake event, then the waited handles.
+    std::vector<int> m_waitIds; ///< Registration of `m_waitHandles[i + 1]`.
+    std::vector<std::pair<int, HANDLE>> m_overflow; ///< Registrations beyond the wait limit, polled.
+#else
+    std::mutex m_fallbackMutex;
+    std::condition_variable m_fallbackCv;
+    bool m_fallbackSignaled = false;
+#endif
+
+    std::atomic<bool> m_waiting{false}; ///< `true` while the loop is blocked or about to block.
+    mutable std::mutex m_registrationMutex;
+    std::map<int, Registration> m_registrations;
+    int m_nextId = 0;
+};
@@ -22,7 +22,9 @@
 
 #include "SwTimer.h"
 #include "SwCoreApplication.h"
+#if defined(_WIN32)
 #include <windows.h>
+#endif
 
 
 /**
@@ -194,13 +196,14 @@ public:
      */
     int exec(int delay = 0) {
         if(running_) return -1; // return if already runing
-        if(delay) SwTimer::singleShot(delay, this, &SwEventLoop::quit); // auto wake up if delay
+        SwTimer::Handle wakeUp;
+        if(delay) wakeUp = SwTimer::singleShot(delay, this, &SwEventLoop::quit); // auto wake up if delay
         exitCode = 0;
         running_ = true;
-        static int _id = 0;
-        id_ = _id++;
+        id_ = SwCoreApplication::generateYieldId();
         SwCoreApplication::instance()->yieldFiber(id_);
         // Control will return here after `unYieldFiber()` is called for `id_`.
+        wakeUp.cancel(); // la boucle peut être détruite avant l'échéance
         return exitCode;
     }
 
@@ -214,7 +217,8 @@ public:
      * - **If called from the main fiber** (before the event loop starts):
      *   - A blocking sleep is used via `std::this_thread::sleep_for`. This is a simple, synchronous
      *     blocking mechanism.
-     * - **If called from a secondary fiber** (after the event loop has started):
+     * - **If called from a secondary fiber** (after the event loop has started), or from a callback
+     *   running with `ExecutionHint::Inline`:
      *   - A non-blocking mechanism is used:
      *     1. A one-shot timer (`SwTimer::singleShot`) is created, which schedules a callback to wake
      *        the current fiber after the specified duration.
@@ -232,10 +236,10 @@ public:
      * 2. If it is the main fiber:
      *    - Use a blocking sleep (`std::this_thread::sleep_for`).
      * 3. If it is a secondary fiber:
-     *    - Assign a unique identifier (`myId`) to the fiber.
-     *    - Set up a one-shot timer that schedules a callback to un-yield the fiber after the specified duration.
-     *    - Yield the current fiber, pausing its execution.
-     *    - The fiber resumes when the timer's callback calls `SwCoreApplication::unYieldFiber`.
+     *    - Park the fiber on the timer heap with `SwCoreApplication::sleepFiberUntil`; the loop
+     *      makes it ready again at the deadline. No timer object or callback is allocated.
+     * 4. In an inline callback (which runs on the main context), fall back to a one-shot timer
+     *    that calls `SwCoreApplication::unYieldFiber`, the loop turning nested meanwhile.
      *
      * ### Example:
      * ```cpp
@@ -246,16 +250,19 @@ public:
      *       enabling non-blocking delays.
      */
     static void swsleep(int milliseconds) {
+        if (SwFiberScheduler::currentScheduler()) {
+            sleepSchedulerTask(milliseconds);
+            return;
+        }
         SwCoreApplication* app = SwCoreApplication::instance(false);
-        LPVOID current = GetCurrentFiber();
+        SwFiber* current = SwFiber::current();
 
-        if (current == app->mainFiber) {
+        if (current == app->mainFiber && !app->isRunningInline()) {
             // If the event loop hasn't started yet (in the main fiber), use a blocking sleep
             std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
-        } else {
-            // If inside a secondary fiber, use non-blocking mechanism
-            static int s_idCounter = 0;
-            int myId = s_idCounter++;
+        } else if (!SwCoreApplication::sleepFiberUntil(SwClock::now() + std::chrono::milliseconds(milliseconds))) {
+            // Callback inline : pas de fibre à garer, on passe par un timer et une boucle imbriquée
+            int myId = SwCoreApplication::generateYieldId();
 
             // Schedule a one-shot timer to wake up the fiber after the specified duration
             SwTimer::singleShot(milliseconds, [myId]() {
@@ -298,8 +305,13 @@ public:
      *      infinite loop.
      *    - Execution yields periodically to avoid blocking the application and to allow other tasks
      *      or events to execute.
-     * 3. The runtime function continues until explicitly stopped or interrupted by other control
-     *    mechanisms in the application.
+     * 3. The runtime function continues until `removeRuntime()` is called with the returned
+     *    identifier.
+     *
+     * ### Fair share:
+     * The time the runtime fiber runs is charged to it by the loop's `SwRuntimeScheduler`. Once
+     * the runtime has used its share of the current period (`weight` against the other runtimes),
+     * it is parked until the next period instead of being called again.
      *
      * ### Example Usage:
      * ```cpp
@@ -309,6 +321,8 @@ public:
      * ```
      *
      * @param fn The function to execute continuously within the local event loop.
+     * @param weight Share of the runtime budget given to this runtime.
+     * @return Identifier of the runtime, for `removeRuntime()` and `SwRuntimeScheduler`.
      *
      * @note By triggering a one-shot timer, this method ensures that a dedicated fiber is created
      *       for the runtime function. This design prevents the current fiber from being blocked and
@@ -318,12 +332,8 @@ public:
      *          explicitly stopped or interrupted. Ensure appropriate safeguards or stopping
      *          mechanisms are in place if needed.
      */
-    static void installRuntime(std::function<void()> fn) {
-        SwTimer::singleShot(0, [fn]() {
-            swLocalLoop() { // Continuous execution without a fixed delay
-                fn();
-            }
-        });
+    static int installRuntime(std::function<void()> fn, int weight = 1) {
+        return startRuntime(0, std::move(fn), weight); // Continuous execution without a fixed delay
     }
 
     /**
@@ -343,7 +353,8 @@ public:
      *      with a delay of `msWait` milliseconds between iterations.
      *    - Execution yields control back to the main event loop during each delay, allowing other
      *      tasks or fibers to execute.
-     * 3. The runtime function continues until explicitly stopped or interrupted by other mechanisms.
+     * 3. The runtime function continues until `removeRuntime()` is called with the returned
+     *    identifier. Its running time is accounted like for `installRuntime()`.
      *
      * ### Example Usage:
      * ```cpp
@@ -354,6 +365,8 @@ public:
      *
      * @param msWait The interval in milliseconds between executions of the runtime function.
      * @param fn The function to execute periodically within the local slow loop.
+     * @param weight Share of the runtime budget given to this runtime.
+     * @return Identifier of the runtime, for `removeRuntime()` and `SwRuntimeScheduler`.
      *
      * @note By triggering a one-shot timer, this method ensures that the runtime function operates
      *       in its own fiber, preventing the current fiber from being blocked. The use of `swLocalSlowLoop`
@@ -362,12 +375,15 @@ public:
      * @warning The runtime function (`fn`) will continue running indefinitely unless explicitly
      *          stopped or interrupted. Ensure appropriate stopping mechanisms or safeguards are in place.
      */
-    static void installSlowRuntime(int msWait, std::function<void()> fn) {
-        SwTimer::singleShot(0, [fn, msWait]() {
-            swLocalSlowLoop(msWait) { // Execute repeatedly with msWait milliseconds delay
-                fn();
-            }
-        });
+    static int installSlowRuntime(int msWait, std::function<void()> fn, int weight = 1) {
+        return startRuntime(msWait, std::move(fn), weight); // Execute repeatedly with msWait milliseconds delay
+    }
+
+    /**
+     * @brief Stops a runtime installed on the calling thread's loop. Its function is not called again.
+     */
+    static void removeRuntime(int runtimeId) {
+        SwCoreApplication::instance()->runtimeScheduler().remove(runtimeId);
     }
 
     /**
@@ -393,6 +409,64 @@ public:
     }
 
 private:
+    /**
+     * @brief `swsleep` for a task of a `SwFiberScheduler`.
+     *
+     * The wake-up timer is armed on the main application once the task has switched out, so the
+     * worker stays free while the task sleeps. Without a main application the worker blocks.
+     */
+    static void sleepSchedulerTask(int milliseconds) {
+        SwCoreApplication* app = SwCoreApplication::instance(false);
+        if (!app) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+            return;
+        }
+        int myId = SwCoreApplication::generateYieldId();
+        SwFiberScheduler::runAfterSuspend([app, milliseconds, myId]() {
+            app->postEventUnbounded([milliseconds, myId]() {
+                SwTimer::singleShot(milliseconds, [myId]() {
+                    SwCoreApplication::unYieldFiber(myId);
+                });
+            }, ExecutionHint::Inline);
+        });
+        SwCoreApplication::yieldFiber(myId);
+    }
+
+    /**
+     * @brief Body shared by `installRuntime` (`msWait == 0`) and `installSlowRuntime`.
+     *
+     * The fiber is tagged with its accounting record (`SwFiber::setUserData`) so that the loop
+     * charges every slice it runs; it is parked until the next period when over budget.
+     */
+    static int startRuntime(int msWait, std::function<void()> fn, int weight) {
+        SwCoreApplication* app = SwCoreApplication::instance();
+        SwRuntimeScheduler::Runtime* runtime = app->runtimeScheduler().install(weight);
+        SwTimer::singleShot(0, [app, runtime, fn, msWait]() {
+            SwRuntimeScheduler& scheduler = app->runtimeScheduler();
+            SwFiber::current()->setUserData(runtime);
+            while (!runtime->stopped) {
+                // Les périodes suivent l'horloge de la boucle, celle de l'échéance de sleepFiberUntil
+                if (scheduler.isOverBudget(runtime, SwClock::now(app->clock()))) {
+                    ++runtime->stats.throttled;
+                    if (!SwCoreApplication::sleepFiberUntil(scheduler.periodEnd())) {
+                        SwCoreApplication::release();
+                    }
+                    continue;
+                }
+                ++runtime->stats.runs;
+                fn();
+                if (msWait > 0) {
+                    swsleep(msWait);
+                } else {
+                    SwCoreApplication::release();
+                }
+            }
+            SwFiber::current()->setUserData(nullptr);
+            scheduler.release(runtime);
+        });
+        return runtime->stats.id;
+    }
+
     bool running_;  ///< Indicates whether the event loop is currently running.
     int id_;        ///< Unique identifier for this event loop instance.
     int exitCode;   ///< Exit code returned by `exec()`.
@@ -0,0 +1,311 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+
+/**
+ * @class SwEventQueue
+ * @brief Intrusive lock-free multi-producer / single-consumer queue of tasks used by `postEvent`.
+ *
+ * Any thread may push a callable; only the thread running the event loop pops. The queue is the
+ * classic intrusive MPSC list: a push is one atomic exchange plus one store, a pop touches no
+ * shared cache line unless the queue is nearly empty. No mutex is ever taken.
+ *
+ * ### Task nodes:
+ * - Each callable is stored inline in a pre-allocated `Node` (small-buffer optimisation). Lambdas
+ *   capturing up to `InlineSize` bytes, including a `std::function`, need no allocation at all.
+ *   Larger callables fall back to a single heap allocation.
+ * - Nodes come from a process-wide pool. Producers take them from a thread-local cache, refilled
+ *   in one atomic exchange from the shared free list; the consumer returns them with a single CAS
+ *   once the task has run. Chunks of nodes are allocated only when the pool runs dry.
+ *
+ * ### Consumer side:
+ * `pop()` returns the oldest node, `SwEventQueue::run()` invokes it and `release()` destroys the
+ * callable and recycles the node. `SwCoreApplication` drains several nodes per loop iteration.
+ *
+ * @note A push that is in progress (exchange done, link not yet published) is reported by
+ *       `isEmpty()` as pending work, while `pop()` may still return `nullptr` for a few cycles.
+ */
+class SwEventQueue {
+public:
+    static const size_t InlineSize = 96; ///< Bytes of callable stored without allocation.
+
+    /**
+     * @brief A queued task. Nodes are owned by the pool and reused forever.
+     */
+    struct Node {
+        std::atomic<Node*> next; ///< Link in the queue, or in the free list when recycled.
+        void (*invokeFn)(void*); ///< Calls the stored callable.
+        void (*destroyFn)(void*); ///< Destroys the stored callable.
+        unsigned int flags; ///< Opaque flags given to `push()` and carried to the consumer.
+        int64_t stamp; ///< Opaque value given to `push()`, e.g. the post time for telemetry.
+        const char* tag; ///< Opaque pointer given to `push()`, e.g. a telemetry source tag.
+        alignas(std::max_align_t) unsigned char storage[InlineSize]; ///< Inline callable storage.
+    };
+
+    /**
+     * @brief Constructs an empty queue and makes sure the pool holds at least `preallocated` nodes.
+     */
+    explicit SwEventQueue(size_t preallocated = 1024)
+        : m_head(&m_stub),
+          m_tail(&m_stub)
+    {
+        m_stub.next.store(nullptr, std::memory_order_relaxed);
+        pool().reserve(preallocated);
+    }
+
+    /**
+     * @brief Destroys the tasks that were never run. Must not race with producers.
+     */
+    ~SwEventQueue() {
+        while (Node* node = pop()) {
+            release(node);
+        }
+    }
+
+    SwEventQueue(const SwEventQueue&) = delete;
+    SwEventQueue& operator=(const SwEventQueue&) = delete;
+
+    /**
+     * @brief Enqueues a callable. Safe to call from any thread.
+     * @param flags Value returned by `flags()` once the node is popped.
+     * @param stamp Value returned by `stamp()` once the node is popped.
+     * @param tag Value returned by `tag()` once the node is popped.
+     */
+    template<typename Callable>
+    void push(Callable&& callable, unsigned int flags = 0, int64_t stamp = 0, const char* tag = nullptr) {
+        typedef typename std::decay<Callable>::type Task;
+        Node* node = pool().acquire();
+        store<Task>(node, std::forward<Callable>(callable));
+        node->flags = flags;
+        node->stamp = stamp;
+        node->tag = tag;
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief Removes the oldest task. Consumer thread only, or callers serialized by the owner.
+     * @return The node, to be passed to `run()` then `release()`, or `nullptr` if nothing is visible yet.
+     */
+    Node* pop() {
+        Node* tail = m_tail.load(std::memory_order_relaxed);
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &m_stub) {
+            if (!next) {
+                return nullptr;
+            }
+            m_tail.store(next, std::memory_order_relaxed);
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            m_tail.store(next, std::memory_order_relaxed);
+            return tail;
+        }
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            return nullptr; // un producteur est en train de chaîner son nœud
+        }
+        // Dernier nœud : on remet le stub derrière lui pour pouvoir le détacher
+        m_stub.next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = m_head.exchange(&m_stub, std::memory_order_acq_rel);
+        prev->next.store(&m_stub, std::memory_order_release);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            m_tail.store(next, std::memory_order_relaxed);
+            return tail;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Returns `true` if no task is queued or being pushed. Consumer thread only.
+     */
+    bool isEmpty() const {
+        return m_tail.load(std::memory_order_relaxed) == &m_stub
+            && m_head.load(std::memory_order_acquire) == &m_stub;
+    }
+
+    /**
+     * @brief Invokes the callable stored in a popped node.
+     */
+    static void run(Node* node) {
+        node->invokeFn(node->storage);
+    }
+
+    /**
+     * @brief Returns the flags the node was pushed with.
+     */
+    static unsigned int flags(const Node* node) {
+        return node->flags;
+    }
+
+    static int64_t stamp(const Node* node) {
+        return node->stamp;
+    }
+
+    static const char* tag(const Node* node) {
+        return node->tag;
+    }
+
+    /**
+     * @brief Destroys the callable stored in a popped node and gives the node back to the pool.
+     */
+    static void release(Node* node) {
+        node->destroyFn(node->storage);
+        pool().recycle(node);
+    }
+
+private:
+    template<typename Task>
+    struct InlineOps {
+        static void invoke(void* storage) { (*static_cast<Task*>(storage))(); }
+        static void destroy(void* storage) { static_cast<Task*>(storage)->~Task(); }
+    };
+
+    template<typename Task>
+    struct HeapOps {
+        static void invoke(void* storage) { (**static_cast<Task**>(storage))(); }
+        static void destroy(void* storage) { delete *static_cast<Task**>(storage); }
+    };
+
+    template<typename Task, typename Callable>
+    static typename std::enable_if<(sizeof(Task) <= InlineSize && alignof(Task) <= alignof(std::max_align_t))>::type
+    store(Node* node, Callable&& callable) {
+        new (node->storage) Task(std::forward<Callable>(callable));
+        node->invokeFn = &InlineOps<Task>::invoke;
+        node->destroyFn = &InlineOps<Task>::destroy;
+    }
+
+    template<typename Task, typename Callable>
+    static typename std::enable_if<!(sizeof(Task) <= InlineSize && alignof(Task) <= alignof(std::max_align_t))>::type
+    store(Node* node, Callable&& callable) {
+        new (node->storage) Task*(new Task(std::forward<Callable>(callable)));
+        node->invokeFn = &HeapOps<Task>::invoke;
+        node->destroyFn = &HeapOps<Task>::destroy;
+    }
+
+    /**
+     * @brief Process-wide pool of nodes shared by every queue.
+     */
+    class NodePool {
+    public:
+        ~NodePool() {
+            for (Node* chunk : m_chunks) {
+                delete[] chunk;
+            }
+        }
+
+        Node* acquire() {
+            LocalCache& cache = localCache();
+            if (!cache.head) {
+                cache.head = m_free.exchange(nullptr, std::memory_order_acquire);
+                if (!cache.head) {
+                    cache.head = allocateChunk();
+                }
+            }
+            Node* node = cache.head;
+            cache.head = node->next.load(std::memory_order_relaxed);
+            return node;
+        }
+
+        void recycle(Node* node) {
+            pushChain(node, node);
+        }
+
+        void reserve(size_t count) {
+            std::lock_guard<std::mutex> lock(m_chunkMutex);
+            while (m_capacity < count) {
+                Node* chunk = allocateChunkLocked();
+                Node* last = chunk + ChunkSize - 1;
+                pushChain(chunk, last);
+            }
+        }
+
+    private:
+        static const size_t ChunkSize = 256;
+
+        struct LocalCache {
+            Node* head = nullptr;
+            ~LocalCache() {
+                if (head) {
+                    Node* last = head;
+                    while (Node* next = last->next.load(std::memory_order_relaxed)) {
+                        last = next;
+                    }
+                    pool().pushChain(head, last);
+                }
+            }
+        };
+
+        static LocalCache& localCache() {
+            static thread_local LocalCache cache;
+            return cache;
+        }
+
+        void pushChain(Node* first, Node* last) {
+            Node* head = m_free.load(std::memory_order_relaxed);
+            do {
+                last->next.store(head, std::memory_order_relaxed);
+            } while (!m_free.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        Node* allocateChunk() {
+            std::lock_guard<std::mutex> lock(m_chunkMutex);
+            return allocateChunkLocked();
+        }
+
+        // Retourne un nouveau bloc déjà chaîné
+        Node* allocateChunkLocked() {
+            Node* chunk = new Node[ChunkSize];
+            for (size_t i = 0; i < ChunkSize; ++i) {
+                chunk[i].next.store(i + 1 < ChunkSize ? &chunk[i + 1] : nullptr, std::memory_order_relaxed);
+            }
+            m_chunks.push_back(chunk);
+            m_capacity += ChunkSize;
+            return chunk;
+        }
+
+        std::atomic<Node*> m_free{nullptr}; ///< Treiber stack of recycled nodes.
+        std::mutex m_chunkMutex; ///< Protects chunk allocation.
+        std::vector<Node*> m_chunks; ///< Every chunk ever allocated, freed at exit.
+        size_t m_capacity = 0; ///< Total number of nodes allocated.
+    };
+
+    static NodePool& pool() {
+        static NodePool instance;
+        return instance;
+    }
+
+    std::atomic<Node*> m_head; ///< Last pushed node, shared by producers.
+    std::atomic<Node*> m_tail; ///< Next node to pop, owned by the consumer.
+    Node m_stub; ///< Placeholder node that keeps the list non-empty.
+};
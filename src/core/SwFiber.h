@@ -0,0 +1,421 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <iostream>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include "SwFiberStackPool.h"
+
+// Les accès TLS ne doivent pas être mis en cache autour d'une bascule : une fibre peut reprendre
+// sur un autre thread (SwFiberScheduler)
+#if defined(_MSC_VER)
+    #define SW_FIBER_NOINLINE __declspec(noinline)
+#else
+    #define SW_FIBER_NOINLINE __attribute__((noinline))
+#endif
+
+#if defined(_WIN32)
+    #define SW_FIBER_WIN32
+    #include <windows.h>
+#elif defined(__x86_64__) && defined(__ELF__)
+    #define SW_FIBER_ASM_X86_64
+#else
+    #define SW_FIBER_UCONTEXT
+    #include <ucontext.h>
+#endif
+
+#if defined(SW_FIBER_ASM_X86_64)
+// Bascule de contexte System V x86-64 : sauvegarde des registres non volatils, de MXCSR et du
+// mot de contrôle x87 sur la pile courante, puis échange des pointeurs de pile.
+// Symbole faible dans un groupe COMDAT : l'en-tête peut être inclus dans plusieurs unités.
+extern "C" void swFiberSwitch(void** fromStack, void* toStack);
+extern "C" void swFiberTrampoline();
+__asm__(
+    ".pushsection .text.swFiberSwitch,\"axG\",@progbits,swFiberSwitch,comdat\n"
+    ".weak swFiberSwitch\n"
+    ".type swFiberSwitch,@function\n"
+    "swFiberSwitch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size swFiberSwitch,.-swFiberSwitch\n"
+    ".weak swFiberTrampoline\n"
+    ".type swFiberTrampoline,@function\n"
+    "swFiberTrampoline:\n"
+    "    movq %r12, %rdi\n"
+    "    andq $-16, %rsp\n"
+    "    callq *%r13\n"
+    "    ud2\n"
+    ".size swFiberTrampoline,.-swFiberTrampoline\n"
+    ".popsection\n"
+);
+#endif
+
+
+/**
+ * @class SwFiber
+ * @brief Reusable execution context (fiber) with its own stack, used by the event loop.
+ *
+ * A fiber runs tasks one after the other: once a task returns, the fiber switches back to the
+ * thread context and waits, fully initialised, for the next task. Creating the context and its
+ * stack is therefore paid once, and `SwFiberPool` keeps finished fibers around for reuse.
+ *
+ * ### Backends:
+ * - **Windows**: native fibers (`CreateFiber` / `SwitchToFiber`).
+ * - **Linux x86-64**: a hand-written context switch that only saves the callee-saved registers
+ *   and the floating point control words. No system call is made on a switch.
+ * - **Other platforms**: `ucontext` (`makecontext` / `swapcontext`).
+ *
+ * ### Stacks:
+ * The stack size is set per fiber (`create(stackSize)`, or `SwFiberPool::setStackSize`), 16-64 KB
+ * being enough for most event handlers. Outside Windows, stacks come from `SwFiberStackPool`
+ * (`mmap` with a guard page, memory committed on first touch); on Windows the fiber reserves
+ * exactly the requested size and commits a single page up front. `stackHighWaterMark()` reports
+ * the deepest usage seen, to size stacks safely.
+ *
+ * ### Usage:
+ * ```cpp
+ * SwFiber* thread = SwFiber::convertCurrentThread();
+ * SwFiber* fiber = SwFiber::create();
+ * fiber->setTask([]() { std::cout << "in fiber" << std::endl; });
+ * SwFiber::switchTo(fiber);    // returns when the task finishes or switches back
+ * if (fiber->isFinished()) {
+ *     SwFiber::destroy(fiber); // or hand it to SwFiberPool
+ * }
+ * ```
+ *
+ * ### Threads:
+ * When a thread fiber resumes a task fiber, it becomes the fiber the task returns to. A
+ * suspended fiber may therefore be resumed by another thread (`SwFiberScheduler` migrates fibers
+ * between its workers), as long as it never runs on two threads at once.
+ *
+ * @warning Code that may migrate must not keep pointers to `thread_local` data across a switch.
+ */
+class SwFiber {
+public:
+    static const size_t DefaultStackSize = 256 * 1024; ///< Stack size used when none is given.
+
+    /**
+     * @brief Scheduling state of a fiber, kept by the fiber itself so that every check is O(1).
+     */
+    enum State {
+        Done,    ///< No task in progress: the fiber is idle and can take a new task.
+        Ready,   ///< Has a task and waits in a ready list to be resumed.
+        Running, ///< Currently executing.
+        Yielded  ///< Suspended until `SwCoreApplication::unYieldFiber` makes it ready again.
+    };
+
+    /**
+     * @brief Turns the calling thread into the fiber that task fibers return to.
+     * @return The thread fiber, created on the first call and owned by the thread.
+     */
+    static SwFiber* convertCurrentThread() {
+        SwFiber*& thread = threadFiber();
+        if (!thread) {
+            static thread_local SwFiber s_threadFiber(true);
+            thread = &s_threadFiber;
+            current() = thread;
+        }
+        return thread;
+    }
+
+    /**
+     * @brief Creates a fiber ready to run tasks.
+     * @param stackSize Stack size in bytes, `0` for `DefaultStackSize`.
+     * @return The new fiber, or `nullptr` if the context could not be created.
+     */
+    static SwFiber* create(size_t stackSize = 0) {
+        SwFiber* fiber = new SwFiber(false);
+        if (!fiber->initialize(stackSize ? stackSize : DefaultStackSize)) {
+            delete fiber;
+            return nullptr;
+        }
+        return fiber;
+    }
+
+    /**
+     * @brief Destroys a fiber created with `create()`. It must not be running.
+     */
+    static void destroy(SwFiber* fiber) {
+        delete fiber;
+    }
+
+    /**
+     * @brief Returns the fiber executing on the calling thread.
+     */
+    static SW_FIBER_NOINLINE SwFiber*& current() {
+        static thread_local SwFiber* s_current = nullptr;
+        return s_current;
+    }
+
+    /**
+     * @brief Returns the thread fiber of the calling thread, or `nullptr` if it was not converted.
+     */
+    static SwFiber* currentThreadFiber() {
+        return threadFiber();
+    }
+
+    /**
+     * @brief Suspends the current fiber and resumes `target`.
+     */
+    static void switchTo(SwFiber* target) {
+        SwFiber* from = current();
+        if (target == from) {
+            return;
+        }
+        current() = target;
+        target->m_state = Running;
+        if (from->m_isThread) {
+            target->m_returnTo = from;
+        }
+#if defined(SW_FIBER_WIN32)
+        (void)from;
+        SwitchToFiber(target->m_handle);
+#elif defined(SW_FIBER_ASM_X86_64)
+        swFiberSwitch(&from->m_stackPointer, target->m_stackPointer);
+#else
+        swapcontext(&from->m_context, &target->m_context);
+#endif
+    }
+
+    /**
+     * @brief Sets the task run the next time the fiber is resumed. The fiber must be idle.
+     */
+    void setTask(std::function<void()> task) {
+        m_task = std::move(task);
+        m_state = Ready;
+    }
+
+    /**
+     * @brief Returns `true` once the task has returned and the fiber can take another one.
+     */
+    bool isFinished() const {
+        return m_state == Done;
+    }
+
+    State state() const {
+        return m_state;
+    }
+
+    /**
+     * @brief Records a transition made by the scheduler (`Ready` or `Yielded` before switching out).
+     */
+    void setState(State state) {
+        m_state = state;
+    }
+
+    /**
+     * @brief Returns `true` for the fiber representing a thread (it owns no stack).
+     */
+    bool isThreadFiber() const {
+        return m_isThread;
+    }
+
+    size_t stackSize() const {
+        return m_stackSize;
+    }
+
+    /**
+     * @brief Returns the largest number of stack bytes used by the fiber, at page granularity.
+     *
+     * On Windows the value is the committed part of the stack, updated each time a task returns;
+     * elsewhere the resident pages of the stack are counted (one `mincore` call).
+     */
+    size_t stackHighWaterMark() const {
+#if defined(SW_FIBER_WIN32)
+        return m_stackHighWater;
+#else
+        return SwFiberStackPool::usedBytes(m_stack);
+#endif
+    }
+
+    /**
+     * @brief Returns the thread fiber that last resumed this fiber, where its task returns.
+     */
+    SwFiber* returnFiber() const {
+        return m_returnTo;
+    }
+
+    /**
+     * @brief Attaches an opaque pointer to the fiber (used by schedulers to find their record).
+     */
+    void setUserData(void* data) {
+        m_userData = data;
+    }
+
+    void* userData() const {
+        return m_userData;
+    }
+
+private:
+    friend class SwFiberReadyList;
+
+    explicit SwFiber(bool isThread)
+        : m_isThread(isThread)
+    {
+        if (isThread) {
+#if defined(SW_FIBER_WIN32)
+            m_handle = ConvertThreadToFiber(nullptr);
+            if (!m_handle) {
+                if (GetLastError() == ERROR_ALREADY_FIBER) {
+                    m_handle = GetCurrentFiber();
+                } else {
+                    std::cerr << "Failed to convert thread to fiber. Error: " << GetLastError() << std::endl;
+                }
+            }
+#endif
+        }
+    }
+
+    ~SwFiber() {
+#if defined(SW_FIBER_WIN32)
+        if (m_handle && !m_isThread) {
+            DeleteFiber(m_handle);
+        }
+#else
+        SwFiberStackPool::instance().release(m_stack);
+#endif
+    }
+
+    SwFiber(const SwFiber&) = delete;
+    SwFiber& operator=(const SwFiber&) = delete;
+
+    static SW_FIBER_NOINLINE SwFiber*& threadFiber() {
+        static thread_local SwFiber* s_threadFiber = nullptr;
+        return s_threadFiber;
+    }
+
+    bool initialize(size_t stackSize) {
+        m_stackSize = stackSize;
+        m_returnTo = convertCurrentThread();
+#if defined(SW_FIBER_WIN32)
+        // Réserve exacte, une seule page engagée : la pile grandit à la demande derrière sa page de garde
+        m_handle = CreateFiberEx(SwFiberStackPool::pageSize(), stackSize, FIBER_FLAG_FLOAT_SWITCH, &SwFiber::fiberProc, this);
+        if (!m_handle) {
+            std::cerr << "Failed to create fiber. Error: " << GetLastError() << std::endl;
+            return false;
+        }
+#else
+        if (!SwFiberStackPool::instance().allocate(stackSize, m_stack)) {
+            std::cerr << "Failed to allocate fiber stack of " << stackSize << " bytes" << std::endl;
+            return false;
+        }
+        m_stackSize = m_stack.size;
+        unsigned char* stackBase = m_stack.base;
+    #if defined(SW_FIBER_ASM_X86_64)
+        // Pile initiale : [mxcsr|fpucw] r15 r14 r13 r12 rbx rbp, puis le trampoline comme adresse de retour
+        uintptr_t top = (reinterpret_cast<uintptr_t>(stackBase) + m_stackSize) & ~static_cast<uintptr_t>(15);
+        uint64_t* frame = reinterpret_cast<uint64_t*>(top) - 9;
+        uint32_t* controlWords = reinterpret_cast<uint32_t*>(frame);
+        controlWords[0] = 0x1F80; // MXCSR par défaut
+        controlWords[1] = 0x037F; // mot de contrôle x87 par défaut
+        frame[1] = 0; // r15
+        frame[2] = 0; // r14
+        frame[3] = reinterpret_cast<uint64_t>(&SwFiber::entryPoint); // r13
+        frame[4] = reinterpret_cast<uint64_t>(this); // r12
+        frame[5] = 0; // rbx
+        frame[6] = 0; // rbp
+        frame[7] = reinterpret_cast<uint64_t>(&swFiberTrampoline);
+        frame[8] = 0; // fausse adresse de retour du point d'entrée
+        m_stackPointer = frame;
+    #else
+        getcontext(&m_context);
+        m_context.uc_stack.ss_sp = stackBase;
+        m_context.uc_stack.ss_size = m_stackSize;
+        m_context.uc_link = nullptr;
+        uintptr_t self = reinterpret_cast<uintptr_t>(this);
+        makecontext(&m_context, reinterpret_cast<void (*)()>(&SwFiber::contextProc), 2,
+                    static_cast<unsigned int>(self >> 32), static_cast<unsigned int>(self & 0xffffffffu));
+    #endif
+#endif
+        return true;
+    }
+
+#if defined(SW_FIBER_WIN32)
+    static VOID WINAPI fiberProc(LPVOID parameter) {
+        entryPoint(static_cast<SwFiber*>(parameter));
+    }
+#elif defined(SW_FIBER_UCONTEXT)
+    static void contextProc(unsigned int high, unsigned int low) {
+        uintptr_t self = (static_cast<uintptr_t>(high) << 32) | static_cast<uintptr_t>(low);
+        entryPoint(reinterpret_cast<SwFiber*>(self));
+    }
+#endif
+
+    /**
+     * @brief Body of every fiber: runs the current task, then parks until the next one.
+     */
+    static void entryPoint(SwFiber* fiber) {
+        for (;;) {
+            fiber->m_task();
+            fiber->m_task = nullptr; // libère les captures avant de rendre la main
+#if defined(SW_FIBER_WIN32)
+            NT_TIB* tib = reinterpret_cast<NT_TIB*>(NtCurrentTeb());
+            size_t committed = static_cast<size_t>(static_cast<char*>(tib->StackBase) - static_cast<char*>(tib->StackLimit));
+            if (committed > fiber->m_stackHighWater) {
+                fiber->m_stackHighWater = committed;
+            }
+#endif
+            fiber->m_state = Done;
+            switchTo(fiber->m_returnTo);
+        }
+    }
+
+    std::function<void()> m_task; ///< Task to run when the fiber is resumed.
+    SwFiber* m_returnTo = nullptr; ///< Thread fiber resumed when the task returns.
+    void* m_userData = nullptr; ///< Opaque pointer owned by whoever schedules the fiber.
+    bool m_isThread; ///< `true` for the fiber created by `convertCurrentThread`.
+    State m_state = Done; ///< Scheduling state, see `State`.
+    SwFiber* m_nextReady = nullptr; ///< Next fiber in the `SwFiberReadyList` holding this one.
+    size_t m_stackSize = 0; ///< Size of the fiber stack in bytes.
+#if defined(SW_FIBER_WIN32)
+    LPVOID m_handle = nullptr; ///< Native fiber handle.
+    size_t m_stackHighWater = 0; ///< Committed stack bytes seen when tasks returned.
+#else
+    SwFiberStackPool::Stack m_stack; ///< Stack memory (none for the thread fiber).
+    #if defined(SW_FIBER_ASM_X86_64)
+    void* m_stackPointer = nullptr; ///< Saved stack pointer while the fiber is suspended.
+    #else
+    ucontext_t m_context; ///< Saved context while the fiber is suspended.
+    #endif
+#endif
+};
@@ -0,0 +1,111 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <mutex>
+#include "SwFiberMutex.h"
+
+
+/**
+ * @class SwFiberConditionVariable
+ * @brief Condition variable for `SwFiberMutex`: waiting parks only the calling fiber.
+ *
+ * `wait()` enrolls the caller, releases the mutex, parks, and locks the mutex again once
+ * notified. Notified waiters are resumed in the order they started waiting.
+ *
+ * ### Example:
+ * ```cpp
+ * SwFiberMutex mutex;
+ * SwFiberConditionVariable ready;
+ * SwList<Job> jobs;
+ *
+ * // consumer fiber
+ * std::unique_lock<SwFiberMutex> lock(mutex);
+ * ready.wait(mutex, [&]() { return !jobs.isEmpty(); });
+ *
+ * // producer
+ * { std::lock_guard<SwFiberMutex> lock(mutex); jobs.append(job); }
+ * ready.notifyOne();
+ * ```
+ */
+class SwFiberConditionVariable {
+public:
+    SwFiberConditionVariable() = default;
+
+    SwFiberConditionVariable(const SwFiberConditionVariable&) = delete;
+    SwFiberConditionVariable& operator=(const SwFiberConditionVariable&) = delete;
+
+    /**
+     * @brief Waits for a notification. `mutex` must be locked by the caller; it is locked again on return.
+     */
+    void wait(SwFiberMutex& mutex) {
+        SwFiberWaiter waiter;
+        SwFiberWaitNode node;
+        node.waiter = &waiter;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            ++m_stats.acquisitions;
+            waiter.prepare();
+            m_waiters.push(&node);
+            m_stats.enqueued(node);
+        }
+        mutex.unlock();
+        waiter.wait();
+        mutex.lock();
+    }
+
+    /**
+     * @brief Waits until `predicate` returns `true`, ignoring wakeups that do not satisfy it.
+     */
+    template<typename Predicate>
+    void wait(SwFiberMutex& mutex, Predicate predicate) {
+        while (!predicate()) {
+            wait(mutex);
+        }
+    }
+
+    void notifyOne() {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        SwFiberWaitNode* next = m_waiters.pop();
+        if (next) {
+            m_stats.resumed(*next);
+            next->waiter->wake();
+        }
+    }
+
+    void notifyAll() {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        while (SwFiberWaitNode* next = m_waiters.pop()) {
+            m_stats.resumed(*next);
+            next->waiter->wake();
+        }
+    }
+
+    SwFiberSyncStats stats() const {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_stats;
+    }
+
+private:
+    mutable std::mutex m_mutex; ///< Protects the wait list.
+    SwFiberWaitList m_waiters; ///< Waiting for a notification, oldest first.
+    SwFiberSyncStats m_stats; ///< Every wait counts as contended.
+};
@@ -0,0 +1,116 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <mutex>
+#include "SwFiberWaiter.h"
+
+
+/**
+ * @class SwFiberMutex
+ * @brief Mutual exclusion between fibers (and threads) that parks only the waiting fiber.
+ *
+ * A contended `lock()` queues the calling fiber on the mutex and yields: its event loop or
+ * `SwFiberScheduler` worker keeps running other work, and the owner may itself park (wait on a
+ * socket, sleep, await a future) while holding the lock. Called from a plain thread, `lock()`
+ * blocks the thread.
+ *
+ * ### Fairness:
+ * `unlock()` hands the mutex straight to the oldest waiter, which is resumed through its ready
+ * queue. Waiters therefore acquire it in arrival order and a fiber that keeps locking cannot
+ * starve the others.
+ *
+ * `lock()` / `unlock()` / `try_lock()` make it usable with `std::lock_guard` and
+ * `std::unique_lock`. It is not recursive.
+ *
+ * @warning A plain thread blocked on a mutex held by a parked fiber of the same thread deadlocks.
+ */
+class SwFiberMutex {
+public:
+    SwFiberMutex()
+        : m_locked(false)
+    {}
+
+    SwFiberMutex(const SwFiberMutex&) = delete;
+    SwFiberMutex& operator=(const SwFiberMutex&) = delete;
+
+    void lock() {
+        SwFiberWaiter waiter;
+        SwFiberWaitNode node;
+        node.waiter = &waiter;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            ++m_stats.acquisitions;
+            if (!m_locked) {
+                m_locked = true;
+                return;
+            }
+            waiter.prepare();
+            m_waiters.push(&node);
+            m_stats.enqueued(node);
+        }
+        waiter.wait(); // unlock() handed the mutex over
+    }
+
+    bool tryLock() {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_locked) {
+            return false;
+        }
+        m_locked = true;
+        ++m_stats.acquisitions;
+        return true;
+    }
+
+    bool try_lock() {
+        return tryLock();
+    }
+
+    void unlock() {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        SwFiberWaitNode* next = m_waiters.pop();
+        if (!next) {
+            m_locked = false;
+            return;
+        }
+        m_stats.resumed(*next);
+        next->waiter->wake();
+    }
+
+    bool isLocked() const {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_locked;
+    }
+
+    /**
+     * @brief Contention counters: `contended / acquisitions` is the share of `lock()` calls that parked.
+     */
+    SwFiberSyncStats stats() const {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_stats;
+    }
+
+private:
+    bool m_locked; ///< Owned by someone (a woken waiter already owns it).
+    mutable std::mutex m_mutex; ///< Protects the state, never held while parked.
+    SwFiberWaitList m_waiters; ///< Waiting for the mutex, oldest first.
+    SwFiberSyncStats m_stats;
+};
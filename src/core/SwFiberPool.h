@@ -0,0 +1,210 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "SwFiber.h"
+
+
+/**
+ * @class SwFiberPool
+ * @brief Pool of idle `SwFiber` contexts reused across events.
+ *
+ * `acquire()` hands out an idle fiber when one is available (a *hit*) and creates a new one
+ * otherwise (a *miss*). `recycle()` takes back a fiber whose task has finished: it is kept for
+ * later if the pool holds fewer than `maxSize()` idle fibers, and destroyed otherwise.
+ *
+ * ### Sizing:
+ * - `warmSize`: number of fibers created up front, so that the first events never pay for a
+ *   fiber creation.
+ * - `maxSize`: maximum number of idle fibers kept. Bursts of events that yield may need more
+ *   fibers at once; the extra ones are destroyed when they finish.
+ * - `stackSize`: stack of each new fiber. Compare it with `Stats::stackHighWater` before going
+ *   below the default; with 32 KB stacks, 100k suspended fibers fit in a few GB of address space.
+ *
+ * @warning A pool belongs to one thread, like the fibers it owns.
+ */
+class SwFiberPool {
+public:
+    /**
+     * @brief Counters describing the pool activity.
+     */
+    struct Stats {
+        uint64_t hits = 0;      ///< Acquisitions served by an idle fiber.
+        uint64_t misses = 0;    ///< Acquisitions that had to create a fiber.
+        uint64_t created = 0;   ///< Fibers created, including the warm-up.
+        uint64_t destroyed = 0; ///< Fibers destroyed because the pool was full.
+        size_t idle = 0;        ///< Fibers currently waiting in the pool.
+        size_t live = 0;        ///< Fibers currently alive (idle or running a task).
+        size_t stackHighWater = 0; ///< Deepest stack usage of the idle and destroyed fibers, in bytes.
+    };
+
+    /**
+     * @brief Constructs a pool. Nothing is allocated before the first `acquire()` or `warmUp()`.
+     * @param warmSize Number of fibers created by `warmUp()`.
+     * @param maxSize Maximum number of idle fibers kept.
+     * @param stackSize Stack size of each fiber in bytes, `0` for the default.
+     */
+    explicit SwFiberPool(size_t warmSize = 16, size_t maxSize = 256, size_t stackSize = 0)
+        : m_warmSize(warmSize),
+          m_maxSize(maxSize < warmSize ? warmSize : maxSize),
+          m_stackSize(stackSize)
+    {}
+
+    ~SwFiberPool() {
+        for (SwFiber* fiber : m_idle) {
+            SwFiber::destroy(fiber);
+        }
+    }
+
+    SwFiberPool(const SwFiberPool&) = delete;
+    SwFiberPool& operator=(const SwFiberPool&) = delete;
+
+    /**
+     * @brief Returns an idle fiber, creating one if the pool is empty.
+     * @return The fiber, or `nullptr` if a new context could not be created.
+     */
+    SwFiber* acquire() {
+        if (!m_idle.empty()) {
+            SwFiber* fiber = m_idle.back();
+            m_idle.pop_back();
+            ++m_stats.hits;
+            return fiber;
+        }
+        ++m_stats.misses;
+        return createFiber();
+    }
+
+    /**
+     * @brief Gives back a fiber whose task has finished.
+     */
+    void recycle(SwFiber* fiber) {
+        if (m_idle.size() < m_maxSize) {
+            m_idle.push_back(fiber);
+            return;
+        }
+        destroyFiber(fiber);
+    }
+
+    /**
+     * @brief Creates fibers until `warmSize()` of them are idle.
+     */
+    void warmUp() {
+        while (m_idle.size() < m_warmSize) {
+            SwFiber* fiber = createFiber();
+            if (!fiber) {
+                break;
+            }
+            m_idle.push_back(fiber);
+        }
+    }
+
+    /**
+     * @brief Sets the number of fibers kept ready and creates the missing ones.
+     */
+    void setWarmSize(size_t warmSize) {
+        m_warmSize = warmSize;
+        if (m_maxSize < warmSize) {
+            m_maxSize = warmSize;
+        }
+        warmUp();
+    }
+
+    size_t warmSize() const {
+        return m_warmSize;
+    }
+
+    /**
+     * @brief Sets the maximum number of idle fibers and destroys the extra ones.
+     */
+    void setMaxSize(size_t maxSize) {
+        m_maxSize = maxSize < m_warmSize ? m_warmSize : maxSize;
+        while (m_idle.size() > m_maxSize) {
+            destroyFiber(m_idle.back());
+            m_idle.pop_back();
+        }
+    }
+
+    size_t maxSize() const {
+        return m_maxSize;
+    }
+
+    /**
+     * @brief Sets the stack size of the fibers created from now on.
+     */
+    void setStackSize(size_t stackSize) {
+        m_stackSize = stackSize;
+    }
+
+    size_t stackSize() const {
+        return m_stackSize ? m_stackSize : SwFiber::DefaultStackSize;
+    }
+
+    /**
+     * @brief Returns the counters. Measuring `stackHighWater` visits every idle fiber.
+     */
+    Stats stats() const {
+        Stats current = m_stats;
+        current.idle = m_idle.size();
+        for (const SwFiber* fiber : m_idle) {
+            current.stackHighWater = (std::max)(current.stackHighWater, fiber->stackHighWaterMark());
+        }
+        return current;
+    }
+
+    void resetStats() {
+        uint64_t created = m_stats.created;
+        uint64_t destroyed = m_stats.destroyed;
+        size_t live = m_stats.live;
+        size_t stackHighWater = m_stats.stackHighWater;
+        m_stats = Stats();
+        m_stats.stackHighWater = stackHighWater;
+        m_stats.created = created;
+        m_stats.destroyed = destroyed;
+        m_stats.live = live;
+    }
+
+private:
+    SwFiber* createFiber() {
+        SwFiber* fiber = SwFiber::create(m_stackSize);
+        if (fiber) {
+            ++m_stats.created;
+            ++m_stats.live;
+        }
+        return fiber;
+    }
+
+    void destroyFiber(SwFiber* fiber) {
+        m_stats.stackHighWater = (std::max)(m_stats.stackHighWater, fiber->stackHighWaterMark());
+        SwFiber::destroy(fiber);
+        ++m_stats.destroyed;
+        --m_stats.live;
+    }
+
+    std::vector<SwFiber*> m_idle; ///< Idle fibers, the most recently used last (its stack is warm in cache).
+    size_t m_warmSize; ///< Fibers created by `warmUp()`.
+    size_t m_maxSize; ///< Maximum number of idle fibers.
+    size_t m_stackSize; ///< Stack size of new fibers, `0` for the default.
+    Stats m_stats; ///< Activity counters.
+};
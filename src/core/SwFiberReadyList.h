@@ -0,0 +1,100 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <atomic>
+#include <cstddef>
+#include "SwFiber.h"
+
+
+/**
+ * @class SwFiberReadyList
+ * @brief Intrusive FIFO of fibers waiting to be resumed by an event loop.
+ *
+ * The links live in the fibers themselves (`SwFiber::m_nextReady`), so pushing and popping never
+ * allocate, and the fiber state tells in O(1) whether a fiber is already queued: pushing a fiber
+ * that is already `Ready` is a no-op instead of a duplicate entry.
+ *
+ * @warning Not thread-safe; `SwCoreApplication` guards it with its ready mutex. Only
+ *          `isEmptyHint()` may be read without it.
+ */
+class SwFiberReadyList {
+public:
+    bool isEmpty() const {
+        return m_head == nullptr;
+    }
+
+    size_t size() const {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Same as `isEmpty()`, readable without the ready mutex; the answer may be stale.
+     *
+     * Lets a spinning loop check for ready fibers without taking the mutex on every round.
+     */
+    bool isEmptyHint() const {
+        return m_size.load(std::memory_order_acquire) == 0;
+    }
+
+    /**
+     * @brief Appends `fiber` and marks it `Ready`.
+     * @return `false` if the fiber was already queued.
+     */
+    bool push(SwFiber* fiber) {
+        if (fiber->m_state == SwFiber::Ready && (fiber->m_nextReady || m_tail == fiber)) {
+            return false;
+        }
+        fiber->m_state = SwFiber::Ready;
+        fiber->m_nextReady = nullptr;
+        if (m_tail) {
+            m_tail->m_nextReady = fiber;
+        } else {
+            m_head = fiber;
+        }
+        m_tail = fiber;
+        // Écrit sous le mutex : une simple écriture atomique suffit, sans instruction verrouillée
+        m_size.store(m_size.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes and returns the oldest fiber, or `nullptr` if the list is empty.
+     */
+    SwFiber* pop() {
+        SwFiber* fiber = m_head;
+        if (!fiber) {
+            return nullptr;
+        }
+        m_head = fiber->m_nextReady;
+        if (!m_head) {
+            m_tail = nullptr;
+        }
+        fiber->m_nextReady = nullptr;
+        m_size.store(m_size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        return fiber;
+    }
+
+private:
+    SwFiber* m_head = nullptr; ///< Next fiber to resume.
+    SwFiber* m_tail = nullptr; ///< Last fiber queued.
+    std::atomic<size_t> m_size{0}; ///< Number of queued fibers, see `isEmptyHint()`.
+};
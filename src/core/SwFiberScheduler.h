@@ -0,0 +1,528 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include "SwFiber.h"
+#include "SwFiberPool.h"
+#include "SwWorkStealingDeque.h"
+
+#if !defined(_WIN32)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+
+/**
+ * @class SwFiberScheduler
+ * @brief M:N scheduler running fibered tasks on a set of worker threads with work stealing.
+ *
+ * Tasks given to `spawn()` run in fibers, like events of `SwCoreApplication`, but a fiber is not
+ * bound to a thread: every worker owns a Chase-Lev deque of ready fibers, idle workers steal from
+ * busy ones, and a fiber woken by `SwCoreApplication::unYieldFiber` is queued on whichever worker
+ * is available. CPU-heavy fibered tasks (JSON transforms, hashing...) are thus balanced across
+ * cores instead of running one after the other on the main loop.
+ *
+ * ### Inside a task:
+ * - `SwCoreApplication::yieldFiber(id)` / `unYieldFiber(id)` park and wake the fiber, from any
+ *   thread. The fiber may resume on another worker.
+ * - `SwCoreApplication::release()` (or `SwFiberScheduler::yield()`) puts the fiber at the back of
+ *   the shared queue, letting other tasks run.
+ * - `SwEventLoop::swsleep(ms)` parks the fiber; the wake-up timer runs on the main application,
+ *   whose loop must be running.
+ *
+ * ### Example:
+ * ```cpp
+ * SwFiberScheduler scheduler(8);
+ * scheduler.start();
+ * for (const SwString& document : documents) {
+ *     scheduler.spawn([document]() { transform(document); });
+ * }
+ * ```
+ *
+ * @warning Tasks may change thread at every suspension point. They must not use objects bound to
+ *          an event loop (`SwTimer`, sockets, `SwObject` slots) directly; post to the owning loop
+ *          instead. Tasks still queued or parked when `stop()` is called are dropped: their fibers
+ *          are freed without unwinding, and a later `unYieldFiber` on a parked one does nothing.
+ */
+class SwFiberScheduler {
+public:
+    /**
+     * @brief Activity counters, summed over all workers.
+     */
+    struct Stats {
+        uint64_t spawned = 0;   ///< Tasks submitted with `spawn()`.
+        uint64_t completed = 0; ///< Tasks whose function returned.
+        uint64_t resumed = 0;   ///< Fiber switches from a worker into a task.
+        uint64_t steals = 0;    ///< Fibers taken from another worker's deque.
+        uint64_t parks = 0;     ///< Suspensions through `yieldFiber`.
+    };
+
+    /**
+     * @brief Constructs a stopped scheduler.
+     * @param workerCount Number of worker threads, `0` for one per hardware thread.
+     * @param pinThreads If `true`, worker `i` is pinned to CPU `i`.
+     */
+    explicit SwFiberScheduler(int workerCount = 0, bool pinThreads = false)
+        : m_workerCount(workerCount > 0 ? workerCount : (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()))),
+          m_pinThreads(pinThreads),
+          m_running(false),
+          m_sleepers(0),
+          m_spawned(0)
+    {}
+
+    ~SwFiberScheduler() {
+        stop();
+    }
+
+    SwFiberScheduler(const SwFiberScheduler&) = delete;
+    SwFiberScheduler& operator=(const SwFiberScheduler&) = delete;
+
+    /**
+     * @brief Starts the worker threads.
+     */
+    void start() {
+        if (m_running.exchange(true)) {
+            return;
+        }
+        for (int i = 0; i < m_workerCount; ++i) {
+            m_workers.push_back(new Worker(this, i));
+        }
+        for (Worker* worker : m_workers) {
+            worker->thread = std::thread(&SwFiberScheduler::workerMain, this, worker);
+        }
+    }
+
+    /**
+     * @brief Stops the workers once their current task suspends or returns, and joins them.
+     */
+    void stop() {
+        if (!m_running.exchange(false)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_idleMutex);
+            m_idleCondition.notify_all();
+        }
+        for (Worker* worker : m_workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        for (Worker* worker : m_workers) {
+            while (Job* job = worker->deque.pop()) {
+                dropJob(job);
+            }
+            delete worker;
+        }
+        m_workers.clear();
+        // Les tâches parquées ne sont dans aucune file : seul leur identifiant de yield les retient
+        releaseParkedJobs();
+        std::lock_guard<std::mutex> lock(m_injectMutex);
+        for (Job* job : m_injected) {
+            dropJob(job);
+        }
+        m_injected.clear();
+    }
+
+    int workerCount() const {
+        return m_workerCount;
+    }
+
+    /**
+     * @brief Submits a task. Safe from any thread.
+     *
+     * From a worker of this scheduler the task goes to that worker's deque (where other workers
+     * may steal it); from any other thread it goes to the shared injection queue.
+     */
+    void spawn(std::function<void()> task) {
+        Job* job = new Job();
+        job->task = std::move(task);
+        m_spawned.fetch_add(1, std::memory_order_relaxed);
+        schedule(job);
+    }
+
+    /**
+     * @brief Returns the scheduler running the calling code, or `nullptr` outside of a task.
+     */
+    static SwFiberScheduler* currentScheduler() {
+        Worker* worker = currentWorker();
+        if (!worker || SwFiber::current() == worker->threadFiber) {
+            return nullptr;
+        }
+        return worker->scheduler;
+    }
+
+    /**
+     * @brief Returns the index of the worker running the calling code, or `-1`.
+     */
+    static int currentWorkerIndex() {
+        Worker* worker = currentWorker();
+        return worker ? worker->index : -1;
+    }
+
+    /**
+     * @brief Lets the other tasks run, then resumes the calling task (possibly on another worker).
+     *
+     * Does nothing outside of a task.
+     */
+    static void yield() {
+        SwFiberScheduler* scheduler = currentScheduler();
+        if (scheduler) {
+            scheduler->suspendCurrent(Yielding);
+        }
+    }
+
+    /**
+     * @brief Parks the calling task until `wake()` is called with its fiber.
+     *
+     * Used by `SwCoreApplication::yieldFiber`, which records the fiber before parking it. A wake
+     * that arrives while the fiber is still switching out is not lost.
+     */
+    void park() {
+        suspendCurrent(Parking);
+    }
+
+    /**
+     * @brief Makes a parked fiber of this scheduler ready again. Safe from any thread.
+     */
+    void wake(SwFiber* fiber) {
+        Job* job = static_cast<Job*>(fiber->userData());
+        int state = job->state.load(std::memory_order_acquire);
+        while (true) {
+            if (state == Parked) {
+                if (job->state.compare_exchange_weak(state, Ready, std::memory_order_acq_rel)) {
+                    schedule(job);
+                    return;
+                }
+            } else if (state == Parking || state == Running) {
+                // Le worker finit de quitter la fibre : il la remettra en file lui-même
+                if (job->state.compare_exchange_weak(state, Woken, std::memory_order_acq_rel)) {
+                    return;
+                }
+            } else {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Runs `action` on the worker right after the calling task has switched out.
+     *
+     * Used to publish a wake-up source (timer, I/O request) only once the task is really
+     * suspended, so that it cannot be resumed while it still runs.
+     */
+    static void runAfterSuspend(std::function<void()> action) {
+        Worker* worker = currentWorker();
+        if (worker) {
+            worker->afterSuspend = std::move(action);
+        }
+    }
+
+    Stats stats() const {
+        Stats total;
+        total.spawned = m_spawned.load(std::memory_order_relaxed);
+        for (const Worker* worker : m_workers) {
+            total.completed += worker->completed.load(std::memory_order_relaxed);
+            total.resumed += worker->resumed.load(std::memory_order_relaxed);
+            total.steals += worker->steals.load(std::memory_order_relaxed);
+            total.parks += worker->parks.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    /**
+     * A parked task goes Running -> Parking (in `suspendCurrent`) -> Parked (on the worker, once
+     * the fiber has switched out) -> Ready (in `wake`). A wake that arrives before the worker
+     * has marked it Parked turns Parking into Woken instead, and the worker requeues the task
+     * itself: it must treat a Woken state read after the switch exactly like a failed
+     * Parking -> Parked exchange, or the wake is lost.
+     */
+    enum JobState {
+        Ready,    ///< Queued, or about to be.
+        Running,  ///< Running on a worker.
+        Yielding, ///< Switching out through `yield()`; requeued by the worker.
+        Parking,  ///< Switching out through `park()`.
+        Parked,   ///< Suspended until `wake()`; in no queue.
+        Woken     ///< Woken while still Parking; requeued by the worker.
+    };
+
+    struct Job {
+        std::function<void()> task; ///< Function run by the task.
+        SwFiber* fiber = nullptr; ///< Fiber of the task, acquired when it first runs.
+        std::atomic<int> state{Ready}; ///< `JobState` of the task.
+    };
+
+    struct Worker {
+        Worker(SwFiberScheduler* owner, int workerIndex)
+            : scheduler(owner),
+              index(workerIndex),
+              randomState(static_cast<uint32_t>(workerIndex) * 2654435761u + 1u)
+        {}
+
+        SwFiberScheduler* scheduler; ///< Owning scheduler.
+        int index; ///< Index of the worker.
+        std::thread thread; ///< Worker thread.
+        SwFiber* threadFiber = nullptr; ///< Fiber of the worker thread.
+        SwWorkStealingDeque<Job> deque; ///< Ready tasks of this worker.
+        SwFiberPool fibers; ///< Idle fibers of this worker.
+        Job* current = nullptr; ///< Task running on this worker.
+        std::function<void()> afterSuspend; ///< Action run once the current task has switched out.
+        uint32_t randomState; ///< Victim selection state (xorshift).
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> resumed{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> parks{0};
+    };
+
+    static SW_FIBER_NOINLINE Worker*& currentWorker() {
+        static thread_local Worker* s_worker = nullptr;
+        return s_worker;
+    }
+
+    void suspendCurrent(JobState state) {
+        Worker* worker = currentWorker();
+        Job* job = worker->current;
+        int expected = Running;
+        if (!job->state.compare_exchange_strong(expected, state, std::memory_order_acq_rel)) {
+            // Réveillée avant même d'avoir été suspendue (unYieldFiber juste après l'enregistrement)
+            job->state.store(Running, std::memory_order_relaxed);
+            return;
+        }
+        SwFiber::switchTo(worker->threadFiber);
+        // Reprise, peut-être sur un autre worker : ne rien lire du thread précédent ici
+    }
+
+    void schedule(Job* job) {
+        Worker* worker = currentWorker();
+        if (worker && worker->scheduler == this) {
+            worker->deque.push(job);
+        } else {
+            std::lock_guard<std::mutex> lock(m_injectMutex);
+            m_injected.push_back(job);
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleepers.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(m_idleMutex);
+            m_idleCondition.notify_one();
+        }
+    }
+
+    Job* takeInjected() {
+        std::lock_guard<std::mutex> lock(m_injectMutex);
+        if (m_injected.empty()) {
+            return nullptr;
+        }
+        Job* job = m_injected.front();
+        m_injected.pop_front();
+        return job;
+    }
+
+    Job* steal(Worker* thief) {
+        const int count = static_cast<int>(m_workers.size());
+        if (count < 2) {
+            return nullptr;
+        }
+        uint32_t x = thief->randomState;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        thief->randomState = x;
+        int start = static_cast<int>(x % static_cast<uint32_t>(count));
+        for (int i = 0; i < count; ++i) {
+            Worker* victim = m_workers[(start + i) % count];
+            if (victim == thief) {
+                continue;
+            }
+            if (Job* job = victim->deque.steal()) {
+                thief->steals.fetch_add(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    Job* findJob(Worker* worker) {
+        if (Job* job = worker->deque.pop()) {
+            return job;
+        }
+        if (Job* job = takeInjected()) {
+            return job;
+        }
+        return steal(worker);
+    }
+
+    bool hasVisibleWork() {
+        {
+            std::lock_guard<std::mutex> lock(m_injectMutex);
+            if (!m_injected.empty()) {
+                return true;
+            }
+        }
+        for (Worker* worker : m_workers) {
+            if (!worker->deque.isEmpty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void runJob(Worker* worker, Job* job) {
+        if (!job->fiber) {
+            job->fiber = worker->fibers.acquire();
+            if (!job->fiber) {
+                std::cerr << "[SwFiberScheduler] Failed to create fiber, running the task synchronously." << std::endl;
+                job->task();
+                worker->completed.fetch_add(1, std::memory_order_relaxed);
+                delete job;
+                return;
+            }
+            job->fiber->setUserData(job);
+            job->fiber->setTask([job]() { job->task(); });
+        }
+
+        worker->current = job;
+        job->state.store(Running, std::memory_order_relaxed);
+        worker->resumed.fetch_add(1, std::memory_order_relaxed);
+        SwFiber::switchTo(job->fiber);
+        worker->current = nullptr;
+
+        if (job->fiber->isFinished()) {
+            job->fiber->setUserData(nullptr);
+            worker->fibers.recycle(job->fiber);
+            delete job;
+            worker->completed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            int state = job->state.load(std::memory_order_acquire);
+            if (state == Yielding) {
+                job->state.store(Ready, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(m_injectMutex);
+                m_injected.push_back(job);
+            } else if (state == Parking || state == Woken) {
+                worker->parks.fetch_add(1, std::memory_order_relaxed);
+                if (state == Woken || !job->state.compare_exchange_strong(state, Parked, std::memory_order_acq_rel)) {
+                    // Réveillée pendant la bascule (avant ou après la lecture de l'état)
+                    job->state.store(Ready, std::memory_order_relaxed);
+                    worker->deque.push(job);
+                }
+            }
+        }
+
+        if (worker->afterSuspend) {
+            std::function<void()> action = std::move(worker->afterSuspend);
+            worker->afterSuspend = nullptr;
+            action();
+        }
+    }
+
+    void workerMain(Worker* worker) {
+        if (m_pinThreads) {
+            pinCurrentThread(worker->index);
+        }
+        currentWorker() = worker;
+        worker->threadFiber = SwFiber::convertCurrentThread();
+
+        int idleRounds = 0;
+        while (m_running.load(std::memory_order_acquire)) {
+            Job* job = findJob(worker);
+            if (job) {
+                idleRounds = 0;
+                runJob(worker, job);
+                continue;
+            }
+            if (++idleRounds < 64) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_idleMutex);
+            m_sleepers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!hasVisibleWork() && m_running.load(std::memory_order_acquire)) {
+                m_idleCondition.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+            idleRounds = 0;
+        }
+        currentWorker() = nullptr;
+    }
+
+    static bool pinCurrentThread(int cpu) {
+#if defined(_WIN32)
+        DWORD_PTR mask = static_cast<DWORD_PTR>(1) << cpu;
+        if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+            std::cerr << "[SwFiberScheduler] SetThreadAffinityMask failed for CPU " << cpu << ". Error: " << GetLastError() << std::endl;
+            return false;
+        }
+        return true;
+#else
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (result != 0) {
+            std::cerr << "[SwFiberScheduler] pthread_setaffinity_np failed for CPU " << cpu << ". Error: " << result << std::endl;
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Frees the tasks still parked by `yieldFiber`. Called by `stop()` once the workers
+     *        are joined.
+     *
+     * Defined in SwCoreApplication.h: the yield identifiers of these tasks are withdrawn there,
+     * so that a late `unYieldFiber` no longer reaches this scheduler.
+     */
+    void releaseParkedJobs();
+
+    void dropJob(Job* job) {
+        if (job->fiber) {
+            job->fiber->setUserData(nullptr);
+            SwFiber::destroy(job->fiber);
+        }
+        delete job;
+    }
+
+    int m_workerCount; ///< Number of worker threads.
+    bool m_pinThreads; ///< Pin worker `i` to CPU `i`.
+    std::atomic<bool> m_running; ///< `false` once `stop()` is called.
+    std::vector<Worker*> m_workers; ///< Workers, fixed between `start()` and `stop()`.
+    std::mutex m_injectMutex; ///< Protects `m_injected`.
+    std::deque<Job*> m_injected; ///< Tasks submitted from outside the workers, and yielded tasks.
+    std::mutex m_idleMutex; ///< Idle workers wait on `m_idleCondition` with this mutex.
+    std::condition_variable m_idleCondition; ///< Signalled when a task becomes ready.
+    std::atomic<int> m_sleepers; ///< Number of workers waiting on `m_idleCondition`.
+    std::atomic<uint64_t> m_spawned; ///< Tasks submitted.
+};
+
+// releaseParkedJobs() est définie avec la table des fibres suspendues
+#include "SwCoreApplication.h"
@@ -0,0 +1,134 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <mutex>
+#include "SwFiberWaiter.h"
+
+
+/**
+ * @class SwFiberSemaphore
+ * @brief Counting semaphore whose `acquire()` parks only the waiting fiber.
+ *
+ * Typical use is capping how many fibers run a section at once (outbound requests, open files)
+ * without polling: the fibers over the limit are queued on the semaphore and resumed, in arrival
+ * order, as permits are released.
+ *
+ * ### Fairness:
+ * Permits released while fibers wait are handed to the oldest waiter first, and `acquire()` does
+ * not overtake queued waiters even when enough permits are free, so a large request is not
+ * starved by small ones.
+ *
+ * ### Example:
+ * ```cpp
+ * SwFiberSemaphore outbound(8); // at most 8 requests in flight
+ *
+ * for (const SwString& url : urls) {
+ *     app.postEvent([&outbound, url]() {
+ *         outbound.acquire();
+ *         fetch(url);          // parks this fiber on the socket
+ *         outbound.release();
+ *     });
+ * }
+ * ```
+ */
+class SwFiberSemaphore {
+public:
+    explicit SwFiberSemaphore(int permits = 0)
+        : m_available(permits)
+    {}
+
+    SwFiberSemaphore(const SwFiberSemaphore&) = delete;
+    SwFiberSemaphore& operator=(const SwFiberSemaphore&) = delete;
+
+    /**
+     * @brief Takes `permits` permits, waiting until they are available.
+     */
+    void acquire(int permits = 1) {
+        SwFiberWaiter waiter;
+        Waiting node;
+        node.waiter = &waiter;
+        node.permits = permits;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            ++m_stats.acquisitions;
+            if (m_waiters.isEmpty() && m_available >= permits) {
+                m_available -= permits;
+                return;
+            }
+            waiter.prepare();
+            m_waiters.push(&node);
+            m_stats.enqueued(node);
+        }
+        waiter.wait(); // release() already took the permits for us
+    }
+
+    /**
+     * @brief Takes `permits` permits only if they are available right away.
+     */
+    bool tryAcquire(int permits = 1) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (!m_waiters.isEmpty() || m_available < permits) {
+            return false;
+        }
+        m_available -= permits;
+        ++m_stats.acquisitions;
+        return true;
+    }
+
+    /**
+     * @brief Returns `permits` permits and resumes the waiters they satisfy, oldest first.
+     */
+    void release(int permits = 1) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_available += permits;
+        while (!m_waiters.isEmpty()) {
+            Waiting* next = static_cast<Waiting*>(m_waiters.front());
+            if (m_available < next->permits) {
+                break;
+            }
+            m_waiters.remove(next);
+            m_available -= next->permits;
+            m_stats.resumed(*next);
+            next->waiter->wake();
+        }
+    }
+
+    int available() const {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_available;
+    }
+
+    SwFiberSyncStats stats() const {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_stats;
+    }
+
+private:
+    struct Waiting : SwFiberWaitNode {
+        int permits = 1; ///< Permits requested.
+    };
+
+    int m_available; ///< Free permits.
+    mutable std::mutex m_mutex; ///< Protects the counter and the wait list.
+    SwFiberWaitList m_waiters; ///< Waiting for permits, oldest first.
+    SwFiberSyncStats m_stats;
+};
@@ -0,0 +1,280 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+
+#if !defined(_WIN32)
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+
+/**
+ * @class SwFiberStackPool
+ * @brief Process-wide allocator of fiber stacks mapped with `mmap`, each protected by a guard page.
+ *
+ * Stacks are carved out of large private anonymous mappings (*slabs* of `StacksPerSlab` stacks)
+ * reserved with `MAP_NORESERVE`: only the pages a fiber actually touches consume memory, which
+ * makes small stacks (16-64 KB) and 100k+ suspended fibers practical. Below each stack, a guard
+ * page is made inaccessible, so an overflow crashes on the spot instead of silently corrupting the
+ * neighbouring stack.
+ *
+ * ### Reuse:
+ * Released stacks are kept per size and handed out again; their pages are returned to the system
+ * with `madvise(MADV_DONTNEED)`, so a released stack only costs address space. Slabs are never
+ * unmapped.
+ *
+ * ### Guard pages and `vm.max_map_count`:
+ * Linux counts each guard page as a separate mapping, two per stack, and limits the number of
+ * mappings per process (`vm.max_map_count`, 65530 by default, i.e. about 32k guarded stacks).
+ * Reaching it would make every later `mmap` fail, `malloc` included, so the pool only guards
+ * stacks while half of the limit (minus a margin) is left; beyond that, stacks are handed out
+ * without guard page and a warning is printed once. Raise the limit (`sysctl vm.max_map_count=262144`) for 100k guarded fibers, or call
+ * `setGuardPages(false)` to keep one mapping per slab.
+ *
+ * ### High-water mark:
+ * `usedBytes()` counts, with `mincore`, the pages of a stack that have been touched from its top:
+ * the deepest point the fiber has reached since the stack was handed out. The pool keeps the
+ * largest value measured on release, to size stacks with a safe margin.
+ *
+ * @note Windows fibers allocate their own stack (`CreateFiberEx` with a small commit and a
+ *       reserve equal to the requested size, guard page included), so this class is only used by
+ *       the other backends.
+ */
+class SwFiberStackPool {
+public:
+    static const size_t StacksPerSlab = 64; ///< Stacks carved out of each mapping.
+
+    /**
+     * @brief A stack handed out by the pool.
+     */
+    struct Stack {
+        unsigned char* base = nullptr; ///< Lowest usable address (just above the guard page).
+        size_t size = 0;               ///< Usable size in bytes, a multiple of the page size.
+    };
+
+    /**
+     * @brief Allocation counters.
+     */
+    struct Stats {
+        uint64_t carved = 0;          ///< Stacks taken from a slab for the first time.
+        uint64_t reused = 0;          ///< Allocations served by a released stack.
+        size_t live = 0;              ///< Stacks currently handed out.
+        size_t cached = 0;            ///< Released stacks waiting for reuse.
+        size_t unguarded = 0;         ///< Stacks handed out without guard page.
+        size_t reservedBytes = 0;     ///< Address space of the slabs, guard pages included.
+        size_t highWaterBytes = 0;    ///< Largest stack usage measured on release.
+    };
+
+    static SwFiberStackPool& instance() {
+        // Jamais détruit : des fibres thread_local peuvent rendre leur pile après les statiques
+        static SwFiberStackPool* s_pool = new SwFiberStackPool();
+        return *s_pool;
+    }
+
+    static size_t pageSize() {
+#if defined(_WIN32)
+        static const size_t s_pageSize = 4096;
+#else
+        static const size_t s_pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+        return s_pageSize;
+    }
+
+    /**
+     * @brief Rounds `size` up to a whole number of pages (one page at least).
+     */
+    static size_t roundToPages(size_t size) {
+        const size_t page = pageSize();
+        size_t rounded = (size + page - 1) / page * page;
+        return rounded ? rounded : page;
+    }
+
+    /**
+     * @brief Hands out a stack of at least `size` usable bytes.
+     * @return `false` if the mapping failed (the address space is exhausted).
+     */
+    bool allocate(size_t size, Stack& stack) {
+        size = roundToPages(size);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<unsigned char*>& cache = m_cache[size];
+        if (!cache.empty()) {
+            stack.base = cache.back();
+            stack.size = size;
+            cache.pop_back();
+            --m_stats.cached;
+            ++m_stats.live;
+            ++m_stats.reused;
+            return true;
+        }
+#if defined(_WIN32)
+        (void)stack;
+        return false;
+#else
+        const size_t guard = pageSize();
+        const size_t slot = size + guard;
+        Slab& slab = m_slabs[size];
+        if (slab.remaining == 0) {
+            void* mapping = mmap(nullptr, slot * StacksPerSlab, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (mapping == MAP_FAILED) {
+                std::cerr << "[SwFiberStackPool] mmap of " << StacksPerSlab << " stacks of " << size << " bytes failed." << std::endl;
+                return false;
+            }
+            slab.next = static_cast<unsigned char*>(mapping);
+            slab.remaining = StacksPerSlab;
+            m_stats.reservedBytes += slot * StacksPerSlab;
+        }
+        unsigned char* slotStart = slab.next;
+        slab.next += slot;
+        --slab.remaining;
+
+        bool guarded = false;
+        if (m_guardPages && m_guardBudget > 0) {
+            guarded = mprotect(slotStart, guard, PROT_NONE) == 0;
+            m_guardBudget = guarded ? m_guardBudget - 1 : 0;
+        }
+        if (!guarded) {
+            ++m_stats.unguarded;
+            if (m_guardPages && !m_guardWarningShown) {
+                m_guardWarningShown = true;
+                std::cerr << "[SwFiberStackPool] Guard page budget exhausted (vm.max_map_count), "
+                          << "new stacks have no guard page." << std::endl;
+            }
+        }
+        stack.base = slotStart + guard;
+        stack.size = size;
+        ++m_stats.carved;
+        ++m_stats.live;
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Takes back a stack. Its contents are discarded.
+     */
+    void release(const Stack& stack) {
+        if (!stack.base) {
+            return;
+        }
+        size_t used = usedBytes(stack);
+#if !defined(_WIN32)
+        // Les pages touchées sont rendues au système : une pile en attente ne coûte que de l'espace d'adressage
+        madvise(stack.base, stack.size, MADV_DONTNEED);
+#endif
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_stats.live;
+        if (used > m_stats.highWaterBytes) {
+            m_stats.highWaterBytes = used;
+        }
+        m_cache[stack.size].push_back(stack.base);
+        ++m_stats.cached;
+    }
+
+    /**
+     * @brief Returns the number of bytes of `stack` touched from its top, at page granularity.
+     *
+     * Stacks grow downwards, so the deepest resident page gives the high-water mark. This costs a
+     * `mincore` system call; call it when sizing stacks, not on every switch.
+     */
+    static size_t usedBytes(const Stack& stack) {
+#if defined(_WIN32)
+        (void)stack;
+        return 0;
+#else
+        if (!stack.base) {
+            return 0;
+        }
+        const size_t page = pageSize();
+        const size_t pages = stack.size / page;
+        std::vector<unsigned char> resident(pages);
+#if defined(__APPLE__)
+        int result = mincore(stack.base, stack.size, reinterpret_cast<char*>(resident.data()));
+#else
+        int result = mincore(stack.base, stack.size, resident.data());
+#endif
+        if (result != 0) {
+            return 0;
+        }
+        for (size_t i = 0; i < pages; ++i) {
+            if (resident[i] & 1) {
+                return stack.size - i * page;
+            }
+        }
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief Enables or disables the guard page of the stacks carved from now on.
+     */
+    void setGuardPages(bool enabled) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_guardPages = enabled;
+    }
+
+    bool guardPages() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_guardPages;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    /**
+     * @brief Mapping from which new stacks of one size are carved.
+     */
+    struct Slab {
+        unsigned char* next = nullptr; ///< Start of the next free slot (guard page first).
+        size_t remaining = 0;          ///< Free slots left.
+    };
+
+    SwFiberStackPool() {
+#if defined(__linux__)
+        size_t maxMapCount = 65530;
+        std::ifstream limit("/proc/sys/vm/max_map_count");
+        limit >> maxMapCount;
+        // Deux mappings par pile gardée ; on laisse de la marge au reste du processus (malloc, bibliothèques)
+        const size_t margin = 8192;
+        m_guardBudget = maxMapCount > 2 * margin ? (maxMapCount - margin) / 2 : 0;
+#endif
+    }
+    SwFiberStackPool(const SwFiberStackPool&) = delete;
+    SwFiberStackPool& operator=(const SwFiberStackPool&) = delete;
+
+    mutable std::mutex m_mutex; ///< Protects the slabs, the cache and the counters.
+    std::unordered_map<size_t, Slab> m_slabs; ///< Current slab, by usable stack size.
+    std::unordered_map<size_t, std::vector<unsigned char*>> m_cache; ///< Released stacks, by usable size.
+    bool m_guardPages = true; ///< Protect a guard page below each new stack.
+    size_t m_guardBudget = static_cast<size_t>(-1); ///< Guard pages that may still be protected.
+    bool m_guardWarningShown = false; ///< The `vm.max_map_count` warning was printed.
+    Stats m_stats; ///< Allocation counters.
+};
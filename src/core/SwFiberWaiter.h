@@ -0,0 +1,213 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include "SwCoreApplication.h"
+
+
+/**
+ * @brief Something parked on a channel or a synchronization primitive: a fiber (parked with
+ *        `yieldFiber`) or a plain thread (blocked on a condition variable).
+ *
+ * Lives on the stack of the waiting code. `prepare()` must be called before it is enrolled, so a
+ * `wake()` that comes before `wait()` is not lost. A woken fiber goes through the ready queue of
+ * its event loop or `SwFiberScheduler`, in wake order.
+ */
+class SwFiberWaiter {
+public:
+    SwFiberWaiter()
+        : m_yieldId(-1),
+          m_signaled(false)
+    {}
+
+    void prepare() {
+        m_signaled.store(false);
+        if (SwCoreApplication::canYield()) {
+            m_yieldId = SwCoreApplication::generateYieldId();
+            SwCoreApplication::prepareYield(m_yieldId);
+        } else {
+            m_yieldId = -1;
+        }
+    }
+
+    /**
+     * @brief Resumes the waiter.
+     * @return `false` if it had already been woken (by another channel of a select).
+     */
+    bool wake() {
+        int yieldId = m_yieldId;
+        if (yieldId >= 0) {
+            if (m_signaled.exchange(true)) {
+                return false;
+            }
+            SwCoreApplication::unYieldFiber(yieldId);
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_signaled.exchange(true)) {
+            return false;
+        }
+        m_condition.notify_one();
+        return true;
+    }
+
+    void wait() {
+        if (m_yieldId >= 0) {
+            SwCoreApplication::yieldFiber(m_yieldId);
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return m_signaled.load(); });
+    }
+
+private:
+    int m_yieldId; ///< Prepared yield identifier of a fiber, `-1` for a thread.
+    std::atomic<bool> m_signaled; ///< Set by the first `wake()`.
+    std::mutex m_mutex; ///< Guards the condition variable of a thread waiter.
+    std::condition_variable m_condition; ///< Blocks a thread waiter.
+};
+
+
+/**
+ * @brief Entry of a waiter in one wait list (a channel select has one per case).
+ */
+struct SwFiberWaitNode {
+    SwFiberWaiter* waiter = nullptr;
+    SwFiberWaitNode* prev = nullptr;
+    SwFiberWaitNode* next = nullptr;
+    std::chrono::steady_clock::time_point since; ///< When the waiter was enrolled (contention stats).
+    bool linked = false; ///< Currently in a wait list.
+};
+
+
+/**
+ * @brief Intrusive FIFO of waiters, protected by the mutex of its owner.
+ */
+class SwFiberWaitList {
+public:
+    bool isEmpty() const {
+        return m_head == nullptr;
+    }
+
+    SwFiberWaitNode* front() const {
+        return m_head;
+    }
+
+    void push(SwFiberWaitNode* node) {
+        node->prev = m_tail;
+        node->next = nullptr;
+        if (m_tail) {
+            m_tail->next = node;
+        } else {
+            m_head = node;
+        }
+        m_tail = node;
+        node->linked = true;
+    }
+
+    void remove(SwFiberWaitNode* node) {
+        if (!node->linked) {
+            return;
+        }
+        if (node->prev) {
+            node->prev->next = node->next;
+        } else {
+            m_head = node->next;
+        }
+        if (node->next) {
+            node->next->prev = node->prev;
+        } else {
+            m_tail = node->prev;
+        }
+        node->prev = node->next = nullptr;
+        node->linked = false;
+    }
+
+    /**
+     * @brief Unlinks and returns the oldest node, `nullptr` if the list is empty.
+     */
+    SwFiberWaitNode* pop() {
+        SwFiberWaitNode* node = m_head;
+        if (node) {
+            remove(node);
+        }
+        return node;
+    }
+
+    /**
+     * @brief Wakes the oldest waiter not already woken elsewhere.
+     */
+    void wakeOne() {
+        while (m_head) {
+            SwFiberWaitNode* node = m_head;
+            remove(node);
+            if (node->waiter->wake()) {
+                return;
+            }
+        }
+    }
+
+    void wakeAll() {
+        while (m_head) {
+            SwFiberWaitNode* node = m_head;
+            remove(node);
+            node->waiter->wake();
+        }
+    }
+
+private:
+    SwFiberWaitNode* m_head = nullptr;
+    SwFiberWaitNode* m_tail = nullptr;
+};
+
+
+/**
+ * @brief Contention counters of a fiber synchronization primitive, updated under its mutex.
+ */
+struct SwFiberSyncStats {
+    uint64_t acquisitions = 0; ///< Successful lock / acquire / wait calls.
+    uint64_t contended = 0;    ///< Of which had to park.
+    uint64_t totalWaitUs = 0;  ///< Time spent parked, summed.
+    uint64_t maxWaitUs = 0;    ///< Longest single wait.
+    size_t waiting = 0;        ///< Currently parked.
+    size_t maxWaiting = 0;     ///< Highest `waiting` seen.
+
+    void enqueued(SwFiberWaitNode& node) {
+        node.since = std::chrono::steady_clock::now();
+        ++contended;
+        maxWaiting = (std::max)(maxWaiting, ++waiting);
+    }
+
+    void resumed(const SwFiberWaitNode& node) {
+        uint64_t waitedUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - node.since).count());
+        --waiting;
+        totalWaitUs += waitedUs;
+        maxWaitUs = (std::max)(maxWaitUs, waitedUs);
+    }
+};
@@ -10,6 +10,7 @@
 #include <ctime>
 #include "SwDateTime.h"
 #include "SwStandardLocation.h"
+#include "SwConcurrent.h"
 
 
 class SwFile : public SwIODevice {
@@ -338,6 +339,16 @@ public:
     }
 
 
+    /**
+     * @brief Copies `source` to `destination` on the global thread pool (see `SwConcurrent::run`).
+     * @return A future of the copy status, completed on the calling event loop.
+     */
+    static SwFuture<bool> copyByChunkAsync(const SwString& source, const SwString& destination, int chunkSize = 1024) {
+        return SwConcurrent::run([source, destination, chunkSize]() {
+            return copyByChunk(source, destination, false, chunkSize);
+        });
+    }
+
     bool copyByChunk(const SwString& destination, bool nonBlocking = true, int chunkSize = 1024) {
         if (filePath_.isEmpty()) {
             std::cerr << "Source file path is not set." << std::endl;
@@ -565,6 +576,18 @@ public:
         return checksum;
     }
 
+    /**
+     * @brief Computes `fileChecksum()` on the global thread pool, without stalling the event loop.
+     * @return A future of the checksum (empty on error), completed on the calling event loop.
+     */
+    SwFuture<SwString> fileChecksumAsync() {
+        SwString path = filePath_;
+        return SwConcurrent::run([path]() {
+            SwFile file(path);
+            return file.fileChecksum();
+        });
+    }
+
     bool writeMetadata(const SwString& key, const SwString& value) {
         // Vérifier si le fichier principal existe
         if (!isFile(filePath_)) {
@@ -0,0 +1,554 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "SwCoreApplication.h"
+
+template<typename T> class SwFuture;
+template<typename T> class SwPromise;
+
+/**
+ * @brief Value stored by a `SwFuture<void>`.
+ */
+struct SwFutureVoid {};
+
+template<typename T>
+struct SwFutureValueType {
+    typedef T Type;
+};
+
+template<>
+struct SwFutureValueType<void> {
+    typedef SwFutureVoid Type;
+};
+
+/**
+ * @brief Return type of a continuation `F` called with the result of a `SwFuture<T>`.
+ */
+template<typename T, typename F>
+struct SwFutureContinuationResult {
+    typedef decltype(std::declval<F&>()(std::declval<T&&>())) Type;
+};
+
+template<typename F>
+struct SwFutureContinuationResult<void, F> {
+    typedef decltype(std::declval<F&>()()) Type;
+};
+
+
+/**
+ * @class SwFutureState
+ * @brief State shared by a `SwPromise` and its `SwFuture`: the result, or the exception, and the
+ *        continuations waiting for it.
+ *
+ * The value is constructed in place inside the state and moved out once by its consumer, so a
+ * result crosses a chain of continuations without being copied.
+ */
+template<typename T>
+class SwFutureState {
+public:
+    typedef typename SwFutureValueType<T>::Type Value;
+
+    SwFutureState()
+        : m_ready(false),
+          m_hasValue(false)
+    {}
+
+    ~SwFutureState() {
+        if (m_hasValue) {
+            valuePointer()->~Value();
+        }
+    }
+
+    SwFutureState(const SwFutureState&) = delete;
+    SwFutureState& operator=(const SwFutureState&) = delete;
+
+    /**
+     * @brief Constructs the result in place and runs the continuations.
+     * @return `false` if the state already had a result.
+     */
+    template<typename... Args>
+    bool setValue(Args&&... args) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_ready) {
+                return false;
+            }
+            new (&m_storage) Value(std::forward<Args>(args)...);
+            m_hasValue = true;
+            m_ready = true;
+        }
+        finish();
+        return true;
+    }
+
+    bool setException(std::exception_ptr exception) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_ready) {
+                return false;
+            }
+            m_exception = exception;
+            m_ready = true;
+        }
+        finish();
+        return true;
+    }
+
+    bool isReady() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_ready;
+    }
+
+    bool hasException() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_ready && m_exception;
+    }
+
+    /**
+     * @brief Runs `continuation` once the result is set: right away if it already is, otherwise
+     *        on the thread that sets it.
+     */
+    void onReady(std::function<void()> continuation) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_ready) {
+                m_continuations.push_back(std::move(continuation));
+                return;
+            }
+        }
+        continuation();
+    }
+
+    /**
+     * @brief Waits for the result.
+     *
+     * A fiber (event loop fiber, inline callback or `SwFiberScheduler` task) is parked with
+     * `yieldFiber`, the rest of its thread keeps running. Any other caller blocks its thread.
+     */
+    void wait() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_ready) {
+                return;
+            }
+        }
+        if (SwCoreApplication::canYield()) {
+            int id = SwCoreApplication::generateYieldId();
+            SwCoreApplication::prepareYield(id);
+            onReady([id]() {
+                SwCoreApplication::unYieldFiber(id);
+            });
+            SwCoreApplication::yieldFiber(id);
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return m_ready; });
+    }
+
+    /**
+     * @brief Moves the result out, or rethrows the exception. The state must be ready.
+     */
+    Value take() {
+        if (m_exception) {
+            std::rethrow_exception(m_exception);
+        }
+        return std::move(*valuePointer());
+    }
+
+    std::exception_ptr exception() const {
+        return m_exception;
+    }
+
+private:
+    Value* valuePointer() {
+        return reinterpret_cast<Value*>(&m_storage);
+    }
+
+    void finish() {
+        std::vector<std::function<void()>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            continuations.swap(m_continuations);
+        }
+        m_condition.notify_all();
+        for (std::function<void()>& continuation : continuations) {
+            continuation();
+        }
+    }
+
+    std::mutex m_mutex; ///< Protects the fields below.
+    std::condition_variable m_condition; ///< Wakes the threads blocked in `wait()`.
+    bool m_ready; ///< A value or an exception was set.
+    bool m_hasValue; ///< `m_storage` holds a constructed value.
+    typename std::aligned_storage<sizeof(Value), alignof(Value)>::type m_storage; ///< The value, constructed in place.
+    std::exception_ptr m_exception; ///< Failure, rethrown by `take()`.
+    std::vector<std::function<void()>> m_continuations; ///< Run once when the result is set.
+};
+
+
+/**
+ * @class SwPromise
+ * @brief Producer side of a `SwFuture`: sets the result once, from any thread.
+ *
+ * Copies of a promise share the same state. When the last copy is destroyed without a result,
+ * the future receives a `std::runtime_error` instead of waiting forever.
+ */
+template<typename T>
+class SwPromise {
+public:
+    typedef typename SwFutureValueType<T>::Type Value;
+
+    SwPromise()
+        : m_state(std::make_shared<SwFutureState<T>>()),
+          m_guard(std::make_shared<BrokenGuard>(m_state))
+    {}
+
+    SwFuture<T> future() const {
+        return SwFuture<T>(m_state);
+    }
+
+    /**
+     * @brief Sets the result (ignored if one was already set). Continuations run on this thread.
+     */
+    template<typename... Args>
+    bool setValue(Args&&... args) {
+        return m_state->setValue(std::forward<Args>(args)...);
+    }
+
+    bool setException(std::exception_ptr exception) {
+        return m_state->setException(exception);
+    }
+
+    bool isFulfilled() const {
+        return m_state->isReady();
+    }
+
+private:
+    /**
+     * @brief Breaks the promise when its last copy goes away.
+     */
+    struct BrokenGuard {
+        explicit BrokenGuard(const std::shared_ptr<SwFutureState<T>>& state)
+            : state(state)
+        {}
+
+        ~BrokenGuard() {
+            if (!state->isReady()) {
+                state->setException(std::make_exception_ptr(std::runtime_error("SwPromise destroyed without a result")));
+            }
+        }
+
+        std::shared_ptr<SwFutureState<T>> state;
+    };
+
+    std::shared_ptr<SwFutureState<T>> m_state; ///< Shared with the future.
+    std::shared_ptr<BrokenGuard> m_guard; ///< Shared by the copies of the promise.
+};
+
+
+/**
+ * @class SwFuture
+ * @brief Result of an asynchronous operation, awaited by parking the current fiber.
+ *
+ * ### Consuming the result:
+ * - `await()` returns the result (or rethrows the exception). In a fiber only that fiber is
+ *   parked; the event loop keeps running. No yield identifier has to be managed by hand.
+ * - `then(fn)` chains `fn(result)` and returns the future of its return value. `fn` runs on the
+ *   thread that sets the result, or on `context`'s loop with `then(context, fn)`.
+ *
+ * A future has a single consumer: the result is moved out by `await()` or by the continuation.
+ *
+ * ### Example:
+ * ```cpp
+ * std::vector<SwFuture<SwString>> replies;
+ * for (Backend* backend : backends) {
+ *     replies.push_back(backend->query(request)); // each completes on its own
+ * }
+ * std::vector<SwString> answers = SwFutures::whenAll(std::move(replies)).await();
+ * ```
+ *
+ * @see SwPromise, SwFutures
+ */
+template<typename T>
+class SwFuture {
+public:
+    typedef typename SwFutureValueType<T>::Type Value;
+
+    SwFuture() = default;
+
+    bool isValid() const {
+        return static_cast<bool>(m_state);
+    }
+
+    bool isReady() const {
+        return m_state && m_state->isReady();
+    }
+
+    bool hasException() const {
+        return m_state && m_state->hasException();
+    }
+
+    /**
+     * @brief Waits for the result without consuming it.
+     */
+    void wait() const {
+        m_state->wait();
+    }
+
+    /**
+     * @brief Runs `callback` once the result is set, without consuming it: right away if it
+     *        already is, otherwise on the thread that sets it.
+     */
+    void onReady(std::function<void()> callback) const {
+        m_state->onReady(std::move(callback));
+    }
+
+    /**
+     * @brief Waits for the result and moves it out; rethrows the exception of a failed operation.
+     */
+    T await() {
+        m_state->wait();
+        return takeResult(std::is_void<T>());
+    }
+
+    /**
+     * @brief Chains `continuation`, called with the result, and returns the future of its return value.
+     *
+     * If this future fails, `continuation` is skipped and the exception is forwarded. An
+     * exception thrown by `continuation` fails the returned future.
+     */
+    template<typename F>
+    SwFuture<typename SwFutureContinuationResult<T, F>::Type> then(F continuation) {
+        typedef typename SwFutureContinuationResult<T, F>::Type R;
+        SwPromise<R> promise;
+        SwFuture<R> next = promise.future();
+        std::shared_ptr<SwFutureState<T>> state = m_state;
+        m_state->onReady([state, promise, continuation]() mutable {
+            settle(promise, state, continuation);
+        });
+        return next;
+    }
+
+    /**
+     * @brief Like `then(continuation)`, but `continuation` runs on the event loop `context`.
+     */
+    template<typename F>
+    SwFuture<typename SwFutureContinuationResult<T, F>::Type> then(SwCoreApplication* context, F continuation) {
+        typedef typename SwFutureContinuationResult<T, F>::Type R;
+        SwPromise<R> promise;
+        SwFuture<R> next = promise.future();
+        std::shared_ptr<SwFutureState<T>> state = m_state;
+        m_state->onReady([context, state, promise, continuation]() mutable {
+            context->postEventUnbounded([state, promise, continuation]() mutable {
+                settle(promise, state, continuation);
+            });
+        });
+        return next;
+    }
+
+private:
+    template<typename U> friend class SwPromise;
+    friend class SwFutures;
+
+    explicit SwFuture(const std::shared_ptr<SwFutureState<T>>& state)
+        : m_state(state)
+    {}
+
+    T takeResult(std::false_type) {
+        return m_state->take();
+    }
+
+    void takeResult(std::true_type) {
+        m_state->take();
+    }
+
+    template<typename F>
+    static auto invokeContinuation(F& continuation, std::shared_ptr<SwFutureState<T>>& state, std::false_type) -> decltype(continuation(state->take())) {
+        return continuation(state->take());
+    }
+
+    template<typename F>
+    static auto invokeContinuation(F& continuation, std::shared_ptr<SwFutureState<T>>&, std::true_type) -> decltype(continuation()) {
+        return continuation();
+    }
+
+    template<typename R, typename F>
+    static void settle(SwPromise<R>& promise, std::shared_ptr<SwFutureState<T>>& state, F& continuation) {
+        if (state->exception()) {
+            promise.setException(state->exception());
+            return;
+        }
+        try {
+            settleValue(promise, state, continuation, std::is_void<R>());
+        } catch (...) {
+            promise.setException(std::current_exception());
+        }
+    }
+
+    template<typename R, typename F>
+    static void settleValue(SwPromise<R>& promise, std::shared_ptr<SwFutureState<T>>& state, F& continuation, std::false_type) {
+        promise.setValue(invokeContinuation(continuation, state, std::is_void<T>()));
+    }
+
+    template<typename R, typename F>
+    static void settleValue(SwPromise<R>& promise, std::shared_ptr<SwFutureState<T>>& state, F& continuation, std::true_type) {
+        invokeContinuation(continuation, state, std::is_void<T>());
+        promise.setValue();
+    }
+
+    std::shared_ptr<SwFutureState<T>> m_state; ///< Shared with the promise.
+};
+
+
+/**
+ * @class SwFutures
+ * @brief Combinators over several `SwFuture`.
+ */
+class SwFutures {
+public:
+    /**
+     * @brief Returns a future holding the results of all `futures`, in the same order.
+     *
+     * It fails with the first exception found, once every future is ready.
+     */
+    template<typename T>
+    static SwFuture<std::vector<T>> whenAll(std::vector<SwFuture<T>> futures) {
+        SwPromise<std::vector<T>> promise;
+        SwFuture<std::vector<T>> result = promise.future();
+        forEachWhenAll(futures, [futures, promise]() mutable {
+            std::vector<T> values;
+            values.reserve(futures.size());
+            for (SwFuture<T>& future : futures) {
+                if (future.m_state->exception()) {
+                    promise.setException(future.m_state->exception());
+                    return;
+                }
+                values.push_back(future.m_state->take());
+            }
+            promise.setValue(std::move(values));
+        });
+        return result;
+    }
+
+    static SwFuture<void> whenAll(std::vector<SwFuture<void>> futures) {
+        SwPromise<void> promise;
+        SwFuture<void> result = promise.future();
+        forEachWhenAll(futures, [futures, promise]() mutable {
+            for (SwFuture<void>& future : futures) {
+                if (future.m_state->exception()) {
+                    promise.setException(future.m_state->exception());
+                    return;
+                }
+            }
+            promise.setValue();
+        });
+        return result;
+    }
+
+    /**
+     * @brief Returns a future holding the index and the result of the first of `futures` to be ready.
+     *
+     * If that future failed, the returned one fails with the same exception. An empty list never
+     * completes.
+     */
+    template<typename T>
+    static SwFuture<std::pair<size_t, T>> whenAny(std::vector<SwFuture<T>> futures) {
+        SwPromise<std::pair<size_t, T>> promise;
+        SwFuture<std::pair<size_t, T>> result = promise.future();
+        std::shared_ptr<std::atomic<bool>> decided = std::make_shared<std::atomic<bool>>(false);
+        for (size_t i = 0; i < futures.size(); ++i) {
+            std::shared_ptr<SwFutureState<T>> state = futures[i].m_state;
+            state->onReady([i, state, promise, decided]() mutable {
+                if (decided->exchange(true)) {
+                    return;
+                }
+                if (state->exception()) {
+                    promise.setException(state->exception());
+                    return;
+                }
+                promise.setValue(i, state->take());
+            });
+        }
+        return result;
+    }
+
+    static SwFuture<size_t> whenAny(std::vector<SwFuture<void>> futures) {
+        SwPromise<size_t> promise;
+        SwFuture<size_t> result = promise.future();
+        std::shared_ptr<std::atomic<bool>> decided = std::make_shared<std::atomic<bool>>(false);
+        for (size_t i = 0; i < futures.size(); ++i) {
+            std::shared_ptr<SwFutureState<void>> state = futures[i].m_state;
+            state->onReady([i, state, promise, decided]() mutable {
+                if (decided->exchange(true)) {
+                    return;
+                }
+                if (state->exception()) {
+                    promise.setException(state->exception());
+                    return;
+                }
+                promise.setValue(i);
+            });
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns a future that already holds `value`.
+     */
+    template<typename T>
+    static SwFuture<typename std::decay<T>::type> ready(T&& value) {
+        SwPromise<typename std::decay<T>::type> promise;
+        promise.setValue(std::forward<T>(value));
+        return promise.future();
+    }
+
+private:
+    /**
+     * @brief Calls `done` once every future of `futures` is ready.
+     */
+    template<typename T, typename F>
+    static void forEachWhenAll(const std::vector<SwFuture<T>>& futures, F done) {
+        if (futures.empty()) {
+            done();
+            return;
+        }
+        std::shared_ptr<std::atomic<size_t>> remaining = std::make_shared<std::atomic<size_t>>(futures.size());
+        std::shared_ptr<F> shared = std::make_shared<F>(std::move(done));
+        for (const SwFuture<T>& future : futures) {
+            future.m_state->onReady([remaining, shared]() {
+                if (remaining->fetch_sub(1) == 1) {
+                    (*shared)();
+                }
+            });
+        }
+    }
+};
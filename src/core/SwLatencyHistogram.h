@@ -0,0 +1,186 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+/**
+ * @class SwLatencyHistogram
+ * @brief Fixed-size log-linear histogram of durations (HDR style), in microseconds.
+ *
+ * Each power of two is split in `SubBuckets` linear buckets, so any recorded value is known
+ * within 1/16 (6.25%) whatever its magnitude, from 1 us to about 12 days. Recording is a bit scan
+ * and an increment, with no allocation and no clock read; percentiles walk the buckets.
+ *
+ * ### Example:
+ * ```cpp
+ * SwLatencyHistogram histogram;
+ * histogram.record(elapsedUs);
+ * uint64_t p99 = histogram.percentile(99.0);
+ * ```
+ *
+ * @warning Not thread-safe: a histogram is fed by one thread (an event loop records its own).
+ */
+class SwLatencyHistogram {
+public:
+    static const int SubBucketBits = 4;
+    static const int SubBuckets = 1 << SubBucketBits; ///< Linear buckets per power of two.
+    static const int MaxMagnitude = 40; ///< Values from 2^40 us up share the last bucket.
+    static const int BucketCount = (MaxMagnitude - SubBucketBits + 1) * SubBuckets;
+
+    SwLatencyHistogram() {
+        reset();
+    }
+
+    void record(uint64_t value) {
+        ++m_buckets[bucketIndex(value)];
+        if (m_count == 0 || value < m_min) {
+            m_min = value;
+        }
+        if (value > m_max) {
+            m_max = value;
+        }
+        ++m_count;
+        m_sum += value;
+    }
+
+    /**
+     * @brief Adds the values recorded in `other`.
+     */
+    void merge(const SwLatencyHistogram& other) {
+        if (other.m_count == 0) {
+            return;
+        }
+        for (int i = 0; i < BucketCount; ++i) {
+            m_buckets[i] += other.m_buckets[i];
+        }
+        if (m_count == 0 || other.m_min < m_min) {
+            m_min = other.m_min;
+        }
+        if (other.m_max > m_max) {
+            m_max = other.m_max;
+        }
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+    }
+
+    void reset() {
+        std::memset(m_buckets, 0, sizeof(m_buckets));
+        m_count = 0;
+        m_sum = 0;
+        m_min = 0;
+        m_max = 0;
+    }
+
+    uint64_t count() const {
+        return m_count;
+    }
+
+    uint64_t min() const {
+        return m_min;
+    }
+
+    uint64_t max() const {
+        return m_max;
+    }
+
+    double mean() const {
+        return m_count ? static_cast<double>(m_sum) / static_cast<double>(m_count) : 0.0;
+    }
+
+    /**
+     * @brief Returns the smallest value such that `percent` % of the recorded values are lower or
+     *        equal, rounded up to the end of its bucket (and never above `max()`).
+     * @param percent Between 0 and 100, e.g. `99.9`.
+     */
+    uint64_t percentile(double percent) const {
+        if (m_count == 0) {
+            return 0;
+        }
+        if (percent <= 0.0) {
+            return m_min;
+        }
+        uint64_t rank = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(m_count) + 0.5);
+        if (rank < 1) {
+            rank = 1;
+        }
+        if (rank >= m_count) {
+            return m_max;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < BucketCount; ++i) {
+            seen += m_buckets[i];
+            if (seen >= rank) {
+                uint64_t upper = bucketUpperBound(i);
+                if (upper > m_max) {
+                    return m_max;
+                }
+                return upper < m_min ? m_min : upper;
+            }
+        }
+        return m_max;
+    }
+
+private:
+    static int highestBit(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    static int bucketIndex(uint64_t value) {
+        if (value < static_cast<uint64_t>(SubBuckets)) {
+            return static_cast<int>(value);
+        }
+        int magnitude = highestBit(value);
+        if (magnitude >= MaxMagnitude) {
+            return BucketCount - 1;
+        }
+        // les SubBucketBits bits qui suivent le bit de poids fort choisissent le sous-intervalle
+        int sub = static_cast<int>((value >> (magnitude - SubBucketBits)) & (SubBuckets - 1));
+        return (magnitude - SubBucketBits + 1) * SubBuckets + sub;
+    }
+
+    static uint64_t bucketUpperBound(int index) {
+        if (index < SubBuckets) {
+            return static_cast<uint64_t>(index);
+        }
+        int shift = index / SubBuckets - 1;
+        uint64_t sub = static_cast<uint64_t>(index % SubBuckets);
+        return ((static_cast<uint64_t>(SubBuckets) + sub + 1) << shift) - 1;
+    }
+
+    uint64_t m_buckets[BucketCount]; ///< Number of values per bucket.
+    uint64_t m_count; ///< Values recorded.
+    uint64_t m_sum; ///< Sum of the values, for the mean.
+    uint64_t m_min; ///< Smallest value, exact.
+    uint64_t m_max; ///< Largest value, exact.
+};
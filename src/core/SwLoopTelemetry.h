@@ -0,0 +1,337 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SwJsonObject.h"
+#include "SwJsonArray.h"
+#include "SwLatencyHistogram.h"
+
+
+/**
+ * @class SwLoopTelemetry
+ * @brief Measurements of one event loop: load windows, event latencies, timer lateness and
+ *        per-source callback timings.
+ *
+ * Owned by `SwCoreApplication` (see `SwCoreApplication::telemetry()` and `telemetrySnapshot()`).
+ *
+ * ### Load:
+ * Always on. Each loop iteration adds its busy and total time to a ring of 60 one-second buckets,
+ * so the 1 s / 10 s / 60 s loads cost an addition per iteration and a sum of at most 61 buckets
+ * per query. The oldest bucket of a window is weighted by the part of it still inside the window.
+ *
+ * ### Latencies:
+ * Off by default (`setEnabled(true)`), as they cost clock reads on each post and each event:
+ * - queueing delay: from `postEvent` to the moment the loop starts the event;
+ * - execution: time the event held the loop, until it returned or first parked its fiber;
+ * - timer lateness: how long after its deadline a timer callback was started;
+ * - wakeup latency: for the first event, timer or sleeping fiber handled after the loop slept or
+ *   spun, the time from its post or deadline to the moment the loop reacted. This is the figure
+ *   `SwCoreApplication::setLatencyProfile` trades CPU for.
+ *
+ * ### Sources:
+ * While a `SwTelemetryTag` is alive on a thread, the events it posts and the timers it arms are
+ * tagged, and their execution time is also recorded per tag.
+ *
+ * @warning Apart from `isEnabled()`, only the thread running the loop may use it.
+ */
+class SwLoopTelemetry {
+public:
+    static const int LoadWindowSeconds = 60; ///< Longest load window.
+
+    /**
+     * @brief Execution times of the callbacks of one source.
+     */
+    struct TagStats {
+        const char* name = nullptr;
+        SwLatencyHistogram execution;
+    };
+
+    SwLoopTelemetry()
+        : m_enabled(false),
+          m_currentSecond(0)
+    {
+        for (int i = 0; i <= LoadWindowSeconds; ++i) {
+            m_load[i] = LoadBucket();
+        }
+    }
+
+    /**
+     * @brief Turns latency recording on or off. The load windows are always maintained.
+     */
+    void setEnabled(bool enabled) {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Safe from any thread: producers read it to decide whether to stamp their events.
+     */
+    bool isEnabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Monotonic time in microseconds, the unit of the event stamps. Never `0`.
+     */
+    static int64_t nowMicroseconds() {
+        return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count()) | 1;
+    }
+
+    /**
+     * @brief The tag of the callbacks registered by the calling thread, `nullptr` if untagged.
+     */
+    static const char*& currentTag() {
+        static thread_local const char* s_tag = nullptr;
+        return s_tag;
+    }
+
+    /**
+     * @brief Accounts for one loop iteration.
+     */
+    void addIteration(std::chrono::steady_clock::time_point now, uint64_t busyMicroseconds, uint64_t totalMicroseconds) {
+        int64_t second = secondOf(now);
+        advanceTo(second);
+        LoadBucket& bucket = m_load[second % (LoadWindowSeconds + 1)];
+        bucket.busyMicroseconds += busyMicroseconds;
+        bucket.totalMicroseconds += totalMicroseconds;
+    }
+
+    /**
+     * @brief Busy share of the loop over the last `seconds` seconds (1 to 60), in percent.
+     */
+    double load(int seconds) const {
+        seconds = (std::max)(1, (std::min)(seconds, LoadWindowSeconds));
+        auto now = std::chrono::steady_clock::now();
+        int64_t second = secondOf(now);
+        double fraction = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(
+            now.time_since_epoch()).count() % 1000000) / 1000000.0;
+        double busy = 0.0;
+        double total = 0.0;
+        for (int age = 0; age <= seconds; ++age) {
+            int64_t bucketSecond = second - age;
+            if (bucketSecond > m_currentSecond || m_currentSecond - bucketSecond > LoadWindowSeconds) {
+                continue; // pas encore écrit, ou déjà recyclé
+            }
+            const LoadBucket& bucket = m_load[bucketSecond % (LoadWindowSeconds + 1)];
+            // le seau le plus ancien ne compte que pour la part encore dans la fenêtre
+            double weight = age == seconds ? 1.0 - fraction : 1.0;
+            busy += weight * static_cast<double>(bucket.busyMicroseconds);
+            total += weight * static_cast<double>(bucket.totalMicroseconds);
+        }
+        return total > 0.0 ? 100.0 * busy / total : 0.0;
+    }
+
+    void recordQueueDelay(uint64_t microseconds) {
+        m_queueDelay.record(microseconds);
+    }
+
+    void recordExecution(uint64_t microseconds, const char* tag) {
+        m_execution.record(microseconds);
+        if (tag) {
+            recordTagged(microseconds, tag);
+        }
+    }
+
+    /**
+     * @brief Records the execution time of a tagged callback that is not a posted event (a timer).
+     */
+    void recordTagged(uint64_t microseconds, const char* tag) {
+        TagStats& stats = m_tags[tag];
+        stats.name = tag;
+        stats.execution.record(microseconds);
+    }
+
+    void recordTimerLateness(uint64_t microseconds) {
+        m_timerLateness.record(microseconds);
+    }
+
+    void recordWakeup(uint64_t microseconds) {
+        m_wakeup.record(microseconds);
+    }
+
+    const SwLatencyHistogram& queueDelay() const {
+        return m_queueDelay;
+    }
+
+    const SwLatencyHistogram& execution() const {
+        return m_execution;
+    }
+
+    const SwLatencyHistogram& timerLateness() const {
+        return m_timerLateness;
+    }
+
+    const SwLatencyHistogram& wakeupLatency() const {
+        return m_wakeup;
+    }
+
+    /**
+     * @brief Per-tag statistics, merged by tag name.
+     */
+    std::vector<TagStats> tagStats() const {
+        std::vector<TagStats> result;
+        for (const auto& entry : m_tags) {
+            bool merged = false;
+            for (TagStats& stats : result) {
+                if (std::string(stats.name) == entry.second.name) {
+                    stats.execution.merge(entry.second.execution);
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged) {
+                result.push_back(entry.second);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Clears the latency histograms and the tags (not the load windows).
+     */
+    void reset() {
+        m_queueDelay.reset();
+        m_execution.reset();
+        m_timerLateness.reset();
+        m_wakeup.reset();
+        m_tags.clear();
+    }
+
+    /**
+     * @brief Summary of a histogram: count, min, mean, p50, p90, p99, p99.9 and max, in microseconds.
+     */
+    static SwJsonObject toJson(const SwLatencyHistogram& histogram) {
+        SwJsonObject json;
+        json.insert("count", jsonCount(histogram.count()));
+        json.insert("min", static_cast<double>(histogram.min()));
+        json.insert("mean", histogram.mean());
+        json.insert("p50", static_cast<double>(histogram.percentile(50.0)));
+        json.insert("p90", static_cast<double>(histogram.percentile(90.0)));
+        json.insert("p99", static_cast<double>(histogram.percentile(99.0)));
+        json.insert("p999", static_cast<double>(histogram.percentile(99.9)));
+        json.insert("max", static_cast<double>(histogram.max()));
+        return json;
+    }
+
+    /**
+     * @brief Load windows, latency histograms and tags as JSON.
+     */
+    SwJsonObject toJson() const {
+        SwJsonObject load;
+        load.insert("1s", this->load(1));
+        load.insert("10s", this->load(10));
+        load.insert("60s", this->load(60));
+
+        SwJsonObject tags;
+        for (const TagStats& stats : tagStats()) {
+            tags.insert(stats.name, toJson(stats.execution));
+        }
+
+        SwJsonObject json;
+        json.insert("enabled", isEnabled());
+        json.insert("load", load);
+        json.insert("queueDelayUs", toJson(m_queueDelay));
+        json.insert("executionUs", toJson(m_execution));
+        json.insert("timerLatenessUs", toJson(m_timerLateness));
+        json.insert("wakeupLatencyUs", toJson(m_wakeup));
+        json.insert("tags", tags);
+        return json;
+    }
+
+    /**
+     * @brief Clamps a counter to the `int` of `SwJsonValue`.
+     */
+    static SwJsonValue jsonCount(uint64_t value) {
+        return SwJsonValue(static_cast<int>((std::min)(value, static_cast<uint64_t>((std::numeric_limits<int>::max)()))));
+    }
+
+private:
+    struct LoadBucket {
+        uint64_t busyMicroseconds = 0;
+        uint64_t totalMicroseconds = 0;
+    };
+
+    static int64_t secondOf(std::chrono::steady_clock::time_point time) {
+        return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count());
+    }
+
+    void advanceTo(int64_t second) {
+        if (second <= m_currentSecond) {
+            return;
+        }
+        // Les seaux des secondes sautées (boucle endormie) sont remis à zéro
+        int64_t first = (std::max)(m_currentSecond + 1, second - LoadWindowSeconds);
+        for (int64_t s = first; s <= second; ++s) {
+            m_load[s % (LoadWindowSeconds + 1)] = LoadBucket();
+        }
+        m_currentSecond = second;
+    }
+
+    std::atomic<bool> m_enabled; ///< Latency recording, read by producers.
+    LoadBucket m_load[LoadWindowSeconds + 1]; ///< One bucket per second, indexed by second modulo 61.
+    int64_t m_currentSecond; ///< Second of the newest bucket.
+    SwLatencyHistogram m_queueDelay;
+    SwLatencyHistogram m_execution;
+    SwLatencyHistogram m_timerLateness;
+    SwLatencyHistogram m_wakeup; ///< Delay of the first callback after the loop waited.
+    std::unordered_map<const char*, TagStats> m_tags; ///< Keyed by the tag pointer, merged by name on export.
+};
+
+
+/**
+ * @class SwTelemetryTag
+ * @brief Tags the events posted and the timers armed by the current thread while it is alive.
+ *
+ * ```cpp
+ * {
+ *     SwTelemetryTag tag("http");
+ *     app.postEvent([request]() { handle(request); }); // timed under "http"
+ * }
+ * ```
+ *
+ * @note The name is kept by pointer: pass a string literal or a string that outlives the loop.
+ */
+class SwTelemetryTag {
+public:
+    explicit SwTelemetryTag(const char* name)
+        : m_previous(SwLoopTelemetry::currentTag())
+    {
+        SwLoopTelemetry::currentTag() = name;
+    }
+
+    ~SwTelemetryTag() {
+        SwLoopTelemetry::currentTag() = m_previous;
+    }
+
+    SwTelemetryTag(const SwTelemetryTag&) = delete;
+    SwTelemetryTag& operator=(const SwTelemetryTag&) = delete;
+
+private:
+    const char* m_previous; ///< Tag restored on destruction.
+};
@@ -22,7 +22,9 @@
 
 #include "SwCoreApplication.h"
 
+#include <atomic>
 #include <iostream>
+#include <memory>
 #include <map>
 #include <vector>
 #include <functional>
@@ -192,9 +194,10 @@ public:                                                                 \
 
 
 enum ConnectionType {
-    DirectConnection,
-    QueuedConnection,
-    BlockingQueuedConnection
+    DirectConnection,         ///< The slot runs immediately, in the emitting thread.
+    QueuedConnection,         ///< The slot is posted to the event loop of the receiver.
+    BlockingQueuedConnection,
+    AutoConnection            ///< Direct when the receiver lives in the emitting loop, queued otherwise.
 };
 
 
@@ -368,7 +371,9 @@ public:
      * @param parent Pointer to the parent Object. Defaults to nullptr if no parent is specified.
      */
     SwObject(SwObject* parent = nullptr) :
-          m_parent(nullptr)
+          m_parent(nullptr),
+          m_threadAffinity(SwCoreApplication::currentLoop()),
+          m_alive(std::make_shared<std::atomic<bool>>(true))
     {
         setParent(parent);
     }
@@ -381,6 +386,8 @@ public:
      * and deleting child objects if necessary (commented out here for customization).
      */
     virtual ~SwObject() {
+        // Les livraisons encore en file vers cet objet seront ignorées
+        m_alive->store(false, std::memory_order_release);
         //emit destroyed();
         //for (auto child : children) {
         //    if (child->m_parent == this) {
@@ -427,17 +434,54 @@ public:
     /**
      * @brief Marks the SwObject for deletion in the next event loop iteration.
      *
-     * This method schedules the deletion of the SwObject using `SwCoreApplication::postEvent`.
+     * This method schedules the deletion of the SwObject using `SwCoreApplication::postEventUnbounded`.
      * The actual deletion occurs asynchronously, ensuring that the SwObject is safely
      * removed without disrupting the current execution flow.
      */
     void deleteLater() {
         SwObject* meAsDurtyToClean = this;
-        SwCoreApplication::instance()->postEvent([meAsDurtyToClean]() {
+        SwCoreApplication* loop = thread();
+        (loop ? loop : SwCoreApplication::instance())->postEventUnbounded([meAsDurtyToClean]() {
             delete meAsDurtyToClean;
         });
     }
 
+    /**
+     * @brief Returns the event loop this object lives in, or `nullptr` if it was created outside any loop.
+     *
+     * An object belongs to the loop of the thread that created it (`SwCoreApplication::currentLoop()`),
+     * until `moveToThread` changes it. `AutoConnection` and `QueuedConnection` deliver the signals
+     * it receives on that loop, and `deleteLater` deletes it there.
+     */
+    SwCoreApplication* thread() const {
+        return m_threadAffinity.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Changes the event loop of this object and of all its children.
+     *
+     * Call it from the thread the object currently lives in, before handing the object over:
+     * from then on only `loop` may use it. Resources already registered on the previous loop
+     * (a running `SwTimer`, an open socket) stay there, so move objects before starting them.
+     *
+     * ```cpp
+     * SwTcpSocket* socket = new SwTcpSocket();
+     * socket->moveToThread(runtime.loop(2));
+     * runtime.postTo(2, [socket]() { socket->connectToHost("10.0.0.1", 9000); });
+     * ```
+     *
+     * @param loop The target loop, `nullptr` to detach the object from any loop.
+     *
+     * @note As in Qt, an object with a parent cannot be moved alone: move its parent.
+     */
+    void moveToThread(SwCoreApplication* loop) {
+        if (m_parent) {
+            std::cerr << "[SwObject] moveToThread: cannot move an object that has a parent." << std::endl;
+            return;
+        }
+        setThreadAffinity(loop);
+    }
+
     /**
      * @brief Safely deletes a pointer and sets it to nullptr.
      *
@@ -469,6 +513,8 @@ public:
         m_parent = parent;
         if (m_parent) {
             m_parent->addChild(this);
+            // Un enfant vit dans la boucle de son parent
+            setThreadAffinity(m_parent->thread());
         }
         newParentEvent(parent);
     }
@@ -578,10 +624,10 @@ public:
      * @param signalName Name of the signal to connect.
      * @param receiver Pointer to the receiver SwObject receiving the signal.
      * @param slot Pointer to the receiver's member function (slot).
-     * @param type Type of connection (e.g., DirectConnection, QueuedConnection, BlockingQueuedConnection). Default is DirectConnection.
+     * @param type Type of connection (e.g., DirectConnection, QueuedConnection, BlockingQueuedConnection). Default is AutoConnection.
      */
     template<typename Sender, typename Receiver, typename... Args>
-    static void connect(Sender* sender, const SwString& signalName, Receiver* receiver, void (Receiver::* slot)(Args...), ConnectionType type = DirectConnection) {
+    static void connect(Sender* sender, const SwString& signalName, Receiver* receiver, void (Receiver::* slot)(Args...), ConnectionType type = AutoConnection) {
         ISlot<Receiver, Args...>* newSlot = new SlotMember<Receiver, Args...>(receiver, slot);
         sender->addConnection(signalName, newSlot, type);
     }
@@ -595,10 +641,10 @@ public:
      * @param sender Pointer to the sender SwObject emitting the signal.
      * @param signalName Name of the signal to connect.
      * @param func The function or lambda to be executed when the signal is emitted.
-     * @param type Type of connection (e.g., DirectConnection, QueuedConnection, BlockingQueuedConnection). Default is DirectConnection.
+     * @param type Type of connection (e.g., DirectConnection, QueuedConnection, BlockingQueuedConnection). Default is AutoConnection.
      */
     template<typename Sender, typename... Args>
-    static void connect(Sender* sender, const SwString& signalName, std::function<void(Args...)> func, ConnectionType type = DirectConnection) {
+    static void connect(Sender* sender, const SwString& signalName, std::function<void(Args...)> func, ConnectionType type = AutoConnection) {
         ISlot<void, Args...>* newSlot = new SlotFunction<Args...>(func);
         sender->addConnection(signalName, newSlot, type);
     }
@@ -614,10 +660,10 @@ public:
      * @param signalName The name of the signal to connect.
      * @param func The lambda to execute when the signal is emitted.
      * @param type Type of connection (e.g., DirectConnection, QueuedConnection, BlockingQueuedConnection).
-     *             Default is DirectConnection.
+     *             Default is AutoConnection.
      */
     template <typename SenderType, typename Func>
-    static void connect(SenderType* sender, const SwString& signalName, Func&& func, ConnectionType type = DirectConnection) {
+    static void connect(SenderType* sender, const SwString& signalName, Func&& func, ConnectionType type = AutoConnection) {
         using traits = function_traits<typename std::decay<Func>::type>;
         using R = typename traits::return_type;
         using args_tuple = typename traits::args_tuple;
@@ -631,7 +677,7 @@ public:
     }
 
     template <typename SenderType, typename ReceiverType, typename Func>
-    static void connect(SenderType* sender, const SwString& signalName, ReceiverType* receiver, Func&& func, ConnectionType type = DirectConnection) {
+    static void connect(SenderType* sender, const SwString& signalName, ReceiverType* receiver, Func&& func, ConnectionType type = AutoConnection) {
         using traits = function_traits<typename std::decay<Func>::type>;
         using R = typename traits::return_type;
         using args_tuple = typename traits::args_tuple;
@@ -660,7 +706,7 @@ public:
      * @param receiver Pointer to the receiver SwObject handling the signal.
      * @param slot The pointer-to-member function representing the slot.
      * @param type Type of connection (e.g., DirectConnection, QueuedConnection, BlockingQueuedConnection).
-     *             Default is DirectConnection.
+     *             Default is AutoConnection.
      *
      * @note This function is designed for modern signal-slot connections but requires further refinement to handle
      *       cases where Sender or Receiver are derived classes or when argument types do not match exactly.
@@ -671,7 +717,7 @@ public:
         void (Sender::*signal)(SignalArgs...),
         Receiver* receiver,
         void (Receiver::*slot)(SlotArgs...),
-        ConnectionType type = DirectConnection
+        ConnectionType type = AutoConnection
         ) {
 
         // // Cast du signal pour gérer le cas où Sender est une classe de base
@@ -771,6 +817,34 @@ public:
         connections[signalName].push_back(std::make_pair(static_cast<void*>(slot), type));
     }
 
+    /**
+     * @brief Removes the connection made with `addConnection` for a given slot object.
+     *
+     * The slot itself is not deleted. It must not be called while `signalName` is being emitted.
+     *
+     * @param signalName The name of the signal the slot is connected to.
+     * @param slot Pointer to the slot passed to `addConnection`.
+     * @return `true` if the connection existed.
+     */
+    template<typename... Args>
+    bool removeConnection(const SwString& signalName, ISlot<Args...>* slot) {
+        auto it = connections.find(signalName);
+        if (it == connections.end()) {
+            return false;
+        }
+        auto& slotsConnetion = it->second;
+        for (auto connection = slotsConnetion.begin(); connection != slotsConnetion.end(); ++connection) {
+            if (connection->first == static_cast<void*>(slot)) {
+                slotsConnetion.erase(connection);
+                if (slotsConnetion.empty()) {
+                    connections.erase(it);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
     /**
      * @brief Retrieves the current sender of the signal.
      *
@@ -963,16 +1037,25 @@ protected:
      * @param args Arguments to pass to the connected slots.
      *
      * - DirectConnection: The slot is invoked immediately in the current thread.
-     * - QueuedConnection: The slot is added to the event queue for later execution.
+     * - QueuedConnection: The slot is posted to the event loop of the receiver (of the sender for a
+     *   slot without receiver), which wakes that loop up if it sleeps. The post bypasses the
+     *   overload policy of that loop, and the slot is skipped if its receiver (the sender, for a
+     *   slot without receiver) has been destroyed in the meantime.
      * - BlockingQueuedConnection: The current thread is blocked until the slot is executed.
+     * - AutoConnection: Direct when the receiver has no loop or lives in the calling loop, queued otherwise.
      */
     template<typename... Args>
     void emitSignal(const SwString& signalName, Args... args) {
         if (connections.size() > 0 && connections.find(signalName) != connections.end()) {
             for (auto& connection : connections[signalName]) {
                 auto slotPtr = connection.first;
-                auto type = connection.second;
+                ConnectionType type = connection.second;
                 ISlot<void, Args...>* slot = static_cast<ISlot<void, Args...>*>(slotPtr);
+                SwCoreApplication* receiverLoop = slot->receiveur() ? static_cast<SwObject*>(slot->receiveur())->thread() : nullptr;
+
+                if (type == AutoConnection) {
+                    type = (!receiverLoop || receiverLoop == SwCoreApplication::currentLoop()) ? DirectConnection : QueuedConnection;
+                }
 
                 if (type == DirectConnection) {
                     if (slot->receiveur()) {
@@ -981,10 +1064,18 @@ protected:
                     slot->invoke(slot->receiveur(), args...);
                 }
                 else if (type == QueuedConnection) {
-                    // Mettre en file d'attente pour un traitement ultérieur
-                    SwCoreApplication::instance()->postEvent([this, slot, args...]() {
+                    // Mettre en file d'attente de la boucle du receveur
+                    SwCoreApplication* target = receiverLoop ? receiverLoop : thread();
+                    std::shared_ptr<std::atomic<bool>> senderAlive = m_alive;
+                    std::shared_ptr<std::atomic<bool>> receiverAlive =
+                        slot->receiveur() ? static_cast<SwObject*>(slot->receiveur())->m_alive : m_alive;
+                    (target ? target : SwCoreApplication::instance())->postEventUnbounded([this, slot, senderAlive, receiverAlive, args...]() {
+                        if (!receiverAlive->load(std::memory_order_acquire)) {
+                            return;
+                        }
                         if (slot->receiveur()) {
-                            static_cast<SwObject*>(slot->receiveur())->setSender(this);
+                            static_cast<SwObject*>(slot->receiveur())->setSender(
+                                senderAlive->load(std::memory_order_acquire) ? this : nullptr);
                         }
                         slot->invoke(slot->receiveur(), args...);
                     });
@@ -1026,7 +1117,16 @@ signals:
     DECLARE_SIGNAL(childAdded)
 
 private:
+    void setThreadAffinity(SwCoreApplication* loop) {
+        m_threadAffinity.store(loop, std::memory_order_release);
+        for (SwObject* child : children) {
+            child->setThreadAffinity(loop);
+        }
+    }
+
     SwObject* m_parent = nullptr;
+    std::atomic<SwCoreApplication*> m_threadAffinity; ///< Loop the object lives in, read by emitters of any thread.
+    std::shared_ptr<std::atomic<bool>> m_alive; ///< Cleared on destruction, checked by the queued deliveries that involve the object.
     std::vector<SwObject*> children;
     SwString objectName;
     std::map<SwString, SwString> properties;
@@ -0,0 +1,288 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+    #include <cerrno>
+    #include <cstring>
+    #if defined(__linux__)
+        #include <sys/prctl.h>
+    #endif
+#endif
+
+
+/**
+ * @struct SwRealtimeProfile
+ * @brief What `SwRealtime::apply` (and `SwCoreApplication::setRealtimeProfile`) does to the calling thread.
+ *
+ * The defaults describe a typical control loop: FIFO priority 80, memory locked, 512 KB of stack
+ * touched in advance, fixed-rate timers. Only the CPU must be chosen, ideally one removed from
+ * the general scheduler (`isolcpus=` or `nohz_full=` on the kernel command line).
+ */
+struct SwRealtimeProfile {
+    /**
+     * @brief Scheduling class of the thread.
+     */
+    enum class Policy {
+        Normal,     ///< Leaves the scheduling class unchanged.
+        Fifo,       ///< `SCHED_FIFO`: runs until it blocks or a higher priority thread wakes up.
+        RoundRobin  ///< `SCHED_RR`: as `Fifo`, with a time slice between threads of equal priority.
+    };
+
+    Policy policy = Policy::Fifo;          ///< Scheduling class.
+    int priority = 80;                     ///< Real-time priority (1-99 on Linux), clamped to the allowed range.
+    bool lockMemory = true;                ///< `mlockall(MCL_CURRENT | MCL_FUTURE)`: no page fault on the hot path.
+    int cpu = -1;                          ///< CPU the thread is pinned to, `-1` to keep the affinity.
+    size_t prefaultStackBytes = 512 * 1024;///< Bytes of the calling thread's stack touched in advance.
+    bool highPrecisionTimers = true;       ///< Timer slack of 1 ns on Linux, 1 ms period on Windows.
+    bool fixedRateTimers = true;           ///< Recurring timers are rearmed from their deadline, not from the pass.
+};
+
+/**
+ * @class SwRealtime
+ * @brief Real-time setup of the calling thread: scheduling class, memory locking, CPU pinning, stack prefault.
+ *
+ * Each step is available on its own, `apply()` runs those a `SwRealtimeProfile` asks for.
+ * Failures are reported on `std::cerr` and leave the thread as it was: most steps need
+ * privileges (`CAP_SYS_NICE` for the scheduling class, `CAP_IPC_LOCK` or a large enough
+ * `RLIMIT_MEMLOCK` for `mlockall`).
+ *
+ * ### Memory:
+ * `lockMemory()` locks every current and future mapping. Fiber stacks already handed out by
+ * `SwFiberStackPool` are faulted in at that point, and slabs mapped later are faulted in when
+ * they are mapped, so fibers do not take page faults either. `prefaultStack()` only matters
+ * for the thread stack, whose unused part is not mapped yet.
+ *
+ * ### Windows:
+ * `Fifo` and `RoundRobin` map to `THREAD_PRIORITY_TIME_CRITICAL`, pinning uses
+ * `SetThreadAffinityMask`. Windows cannot lock a whole process, `lockMemory()` fails.
+ */
+class SwRealtime {
+public:
+    /**
+     * @brief Sets the scheduling class and priority of the calling thread.
+     * @return `true` on success.
+     */
+    static bool setSchedulingPolicy(SwRealtimeProfile::Policy policy, int priority) {
+        if (policy == SwRealtimeProfile::Policy::Normal) {
+            return true;
+        }
+#if defined(_WIN32)
+        (void)priority;
+        if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+            std::cerr << "[SwRealtime] SetThreadPriority failed. Error: " << GetLastError() << std::endl;
+            return false;
+        }
+        return true;
+#else
+        int native = (policy == SwRealtimeProfile::Policy::Fifo) ? SCHED_FIFO : SCHED_RR;
+        sched_param param;
+        param.sched_priority = (std::min)((std::max)(priority, sched_get_priority_min(native)), sched_get_priority_max(native));
+        int result = pthread_setschedparam(pthread_self(), native, &param);
+        if (result != 0) {
+            std::cerr << "[SwRealtime] pthread_setschedparam failed: " << std::strerror(result) << std::endl;
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Locks the current and future pages of the process in memory.
+     * @return `true` on success.
+     */
+    static bool lockMemory() {
+#if defined(_WIN32)
+        std::cerr << "[SwRealtime] Locking the whole process memory is not supported on Windows." << std::endl;
+        return false;
+#else
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            std::cerr << "[SwRealtime] mlockall failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Pins the calling thread to one CPU.
+     * @return `true` on success.
+     */
+    static bool pinCurrentThread(int cpu) {
+#if defined(_WIN32)
+        DWORD_PTR mask = static_cast<DWORD_PTR>(1) << cpu;
+        if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+            std::cerr << "[SwRealtime] SetThreadAffinityMask failed for CPU " << cpu << ". Error: " << GetLastError() << std::endl;
+            return false;
+        }
+        return true;
+#else
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (result != 0) {
+            std::cerr << "[SwRealtime] pthread_setaffinity_np failed for CPU " << cpu << ": " << std::strerror(result) << std::endl;
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Returns the CPUs removed from the general scheduler (`isolcpus=`), empty if none or unknown.
+     */
+    static std::vector<int> isolatedCpus() {
+        std::vector<int> cpus;
+#if defined(__linux__)
+        std::ifstream file("/sys/devices/system/cpu/isolated");
+        std::string list;
+        if (!std::getline(file, list)) {
+            return cpus;
+        }
+        // Format "2,4-7"
+        size_t pos = 0;
+        while (pos < list.size()) {
+            size_t end = list.find(',', pos);
+            if (end == std::string::npos) {
+                end = list.size();
+            }
+            std::string range = list.substr(pos, end - pos);
+            size_t dash = range.find('-');
+            if (!range.empty()) {
+                int first = std::atoi(range.c_str());
+                int last = (dash == std::string::npos) ? first : std::atoi(range.c_str() + dash + 1);
+                for (int cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(cpu);
+                }
+            }
+            pos = end + 1;
+        }
+#endif
+        return cpus;
+    }
+
+    /**
+     * @brief Returns `true` if `cpu` is removed from the general scheduler.
+     */
+    static bool isCpuIsolated(int cpu) {
+        std::vector<int> cpus = isolatedCpus();
+        for (int isolated : cpus) {
+            if (isolated == cpu) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Touches `bytes` of the calling thread's stack so that later calls do not fault them in.
+     *
+     * With `lockMemory()` applied first, the touched pages also stay resident.
+     */
+    static void prefaultStack(size_t bytes) {
+        touchStack(bytes / PrefaultChunk + 1);
+    }
+
+    /**
+     * @brief Lowers the timer resolution of the calling thread (Linux timer slack, Windows timer period).
+     * @return `true` on success.
+     */
+    static bool enableHighPrecisionTimers() {
+#if defined(_WIN32)
+        HMODULE hWinMM = LoadLibrary(TEXT("winmm.dll"));
+        bool ok = false;
+        if (hWinMM) {
+            auto timeBeginPeriodFunc = (MMRESULT(WINAPI*)(UINT))GetProcAddress(hWinMM, "timeBeginPeriod");
+            ok = timeBeginPeriodFunc && timeBeginPeriodFunc(1) == TIMERR_NOERROR;
+            FreeLibrary(hWinMM);
+        }
+        return ok;
+#elif defined(__linux__)
+        // Le slack par défaut (50 µs) retarde volontairement les réveils des threads non temps réel
+        if (prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL) != 0) {
+            std::cerr << "[SwRealtime] PR_SET_TIMERSLACK failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+#else
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Applies the steps `profile` asks for to the calling thread.
+     * @return `true` if every step succeeded. The steps that failed are reported on `std::cerr`.
+     */
+    static bool apply(const SwRealtimeProfile& profile) {
+        bool ok = true;
+        // La mémoire d'abord : les pages touchées ensuite restent verrouillées
+        if (profile.lockMemory) {
+            ok = lockMemory() && ok;
+        }
+        if (profile.cpu >= 0) {
+            if (!isolatedCpus().empty() && !isCpuIsolated(profile.cpu)) {
+                std::cerr << "[SwRealtime] CPU " << profile.cpu << " is not isolated, other tasks may run on it." << std::endl;
+            }
+            ok = pinCurrentThread(profile.cpu) && ok;
+        }
+        if (profile.prefaultStackBytes > 0) {
+            prefaultStack(profile.prefaultStackBytes);
+        }
+        if (profile.highPrecisionTimers) {
+            ok = enableHighPrecisionTimers() && ok;
+        }
+        ok = setSchedulingPolicy(profile.policy, profile.priority) && ok;
+        return ok;
+    }
+
+private:
+    static const size_t PrefaultChunk = 16 * 1024;
+
+#if defined(_MSC_VER)
+    __declspec(noinline)
+#else
+    __attribute__((noinline))
+#endif
+    static void touchStack(size_t chunks) {
+        volatile char chunk[PrefaultChunk];
+        for (size_t i = 0; i < PrefaultChunk; i += 4096) {
+            chunk[i] = 0;
+        }
+        if (chunks > 1) {
+            touchStack(chunks - 1);
+        }
+        chunk[0] = chunk[0]; // empêche l'appel terminal d'être transformé en boucle
+    }
+};
@@ -0,0 +1,269 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <map>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include "SwString.h"
+
+
+/**
+ * @class SwRuntimeScheduler
+ * @brief Fair-share accounting of the runtimes installed on an event loop.
+ *
+ * `SwEventLoop::installRuntime` and `installSlowRuntime` run a function forever in a fiber. The
+ * scheduler gives each of these runtimes a weight, measures the time its fiber actually runs (each
+ * slice between a resume and the next switch back to the loop) and keeps it within a budget per
+ * period. A runtime that has used up its budget is parked until the next period, so a misbehaving
+ * background task cannot delay the events and the other runtimes for long.
+ *
+ * ### Budgets:
+ * Every `period()`, the runtimes share `runtimeShare() * period()` of loop time in proportion to
+ * their weights. A runtime may also be given an explicit budget with `setBudget()`. A slice that
+ * overruns the budget is carried over as debt to the following periods (one period at most).
+ *
+ * ### Example:
+ * ```cpp
+ * int indexer = SwEventLoop::installRuntime([]() { indexSomeFiles(); }, 1);
+ * SwEventLoop::installRuntime([]() { pollSensors(); }, 4);
+ * SwCoreApplication::instance()->runtimeScheduler().setBudget(indexer, 2000); // 2 ms per period
+ * ```
+ *
+ * @note Every method must be called from the thread of the event loop that owns the scheduler.
+ */
+class SwRuntimeScheduler {
+public:
+    /**
+     * @brief Statistics of one runtime.
+     */
+    struct RuntimeStats {
+        int id = -1;                       ///< Identifier returned by `install()`.
+        SwString name;                     ///< Optional name given at installation.
+        int weight = 1;                    ///< Share of the runtime budget.
+        int64_t budgetMicroseconds = 0;    ///< Budget per period currently applied.
+        uint64_t slices = 0;               ///< Times the runtime fiber was resumed.
+        uint64_t runs = 0;                 ///< Calls of the runtime function.
+        uint64_t cpuMicroseconds = 0;      ///< Total time spent running.
+        uint64_t maxSliceMicroseconds = 0; ///< Longest uninterrupted slice.
+        uint64_t throttled = 0;            ///< Times the runtime was parked for exceeding its budget.
+        double lastPeriodShare = 0.0;      ///< Fraction of the last full period spent in this runtime.
+    };
+
+    /**
+     * @brief Accounting record of a runtime, owned by the scheduler.
+     */
+    struct Runtime {
+        RuntimeStats stats;              ///< Exposed counters.
+        int64_t explicitBudget = 0;      ///< Budget set with `setBudget`, `0` to use the weight.
+        int64_t consumed = 0;            ///< Time used in the current period, debt included.
+        int64_t consumedLastPeriod = 0;  ///< Time used during the previous period.
+        bool stopped = false;            ///< Set by `remove()`; the fiber exits at its next turn.
+    };
+
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    SwRuntimeScheduler()
+        : m_periodMicroseconds(100000),
+          m_runtimeShare(0.5),
+          m_nextId(0),
+          m_periodEnd(std::chrono::steady_clock::now() + std::chrono::microseconds(m_periodMicroseconds))
+    {}
+
+    ~SwRuntimeScheduler() {
+        for (auto& entry : m_runtimes) {
+            delete entry.second;
+        }
+    }
+
+    SwRuntimeScheduler(const SwRuntimeScheduler&) = delete;
+    SwRuntimeScheduler& operator=(const SwRuntimeScheduler&) = delete;
+
+    /**
+     * @brief Sets the accounting period (default 100 ms).
+     */
+    void setPeriod(int64_t microseconds) {
+        m_periodMicroseconds = (std::max)(int64_t(1000), microseconds);
+    }
+
+    int64_t period() const {
+        return m_periodMicroseconds;
+    }
+
+    /**
+     * @brief Sets the fraction of each period shared by the runtimes (default 0.5).
+     */
+    void setRuntimeShare(double share) {
+        m_runtimeShare = (std::min)(1.0, (std::max)(0.01, share));
+    }
+
+    double runtimeShare() const {
+        return m_runtimeShare;
+    }
+
+    /**
+     * @brief Registers a runtime and returns its accounting record.
+     */
+    Runtime* install(int weight, const SwString& name = SwString()) {
+        Runtime* runtime = new Runtime();
+        runtime->stats.id = m_nextId++;
+        runtime->stats.name = name;
+        runtime->stats.weight = (std::max)(1, weight);
+        m_runtimes[runtime->stats.id] = runtime;
+        updateSharedWeight();
+        return runtime;
+    }
+
+    /**
+     * @brief Asks a runtime to stop. Its function is not called again.
+     */
+    void remove(int id) {
+        auto it = m_runtimes.find(id);
+        if (it != m_runtimes.end()) {
+            it->second->stopped = true;
+            updateSharedWeight();
+        }
+    }
+
+    /**
+     * @brief Forgets a stopped runtime; called by its fiber when it exits.
+     */
+    void release(Runtime* runtime) {
+        m_runtimes.erase(runtime->stats.id);
+        delete runtime;
+        updateSharedWeight();
+    }
+
+    void setWeight(int id, int weight) {
+        auto it = m_runtimes.find(id);
+        if (it != m_runtimes.end()) {
+            it->second->stats.weight = (std::max)(1, weight);
+            updateSharedWeight();
+        }
+    }
+
+    /**
+     * @brief Gives a runtime a fixed budget per period, `0` to derive it from its weight again.
+     */
+    void setBudget(int id, int64_t microseconds) {
+        auto it = m_runtimes.find(id);
+        if (it != m_runtimes.end()) {
+            it->second->explicitBudget = (std::max)(int64_t(0), microseconds);
+            updateSharedWeight();
+        }
+    }
+
+    /**
+     * @brief Returns `true` if the runtime has used its budget for the current period.
+     * @param now Time of the loop clock (`SwClock`), the timebase of `periodEnd()`.
+     */
+    bool isOverBudget(Runtime* runtime, TimePoint now) {
+        rollPeriod(now);
+        return runtime->consumed >= budgetOf(runtime);
+    }
+
+    /**
+     * @brief End of the current period, when parked runtimes get a new budget, on the loop clock.
+     */
+    TimePoint periodEnd() const {
+        return m_periodEnd;
+    }
+
+    /**
+     * @brief Records a slice of `microseconds` run by the runtime fiber.
+     */
+    void charge(Runtime* runtime, int64_t microseconds) {
+        if (microseconds < 0) {
+            microseconds = 0;
+        }
+        runtime->consumed += microseconds;
+        runtime->stats.slices++;
+        runtime->stats.cpuMicroseconds += static_cast<uint64_t>(microseconds);
+        if (static_cast<uint64_t>(microseconds) > runtime->stats.maxSliceMicroseconds) {
+            runtime->stats.maxSliceMicroseconds = static_cast<uint64_t>(microseconds);
+        }
+    }
+
+    /**
+     * @brief Returns the statistics of every runtime, in installation order.
+     */
+    std::vector<RuntimeStats> stats() const {
+        std::vector<RuntimeStats> result;
+        result.reserve(m_runtimes.size());
+        for (const auto& entry : m_runtimes) {
+            RuntimeStats current = entry.second->stats;
+            current.budgetMicroseconds = budgetOf(entry.second);
+            current.lastPeriodShare = static_cast<double>(entry.second->consumedLastPeriod) / static_cast<double>(m_periodMicroseconds);
+            result.push_back(current);
+        }
+        return result;
+    }
+
+    size_t count() const {
+        return m_runtimes.size();
+    }
+
+private:
+    int64_t budgetOf(const Runtime* runtime) const {
+        if (runtime->explicitBudget > 0) {
+            return runtime->explicitBudget;
+        }
+        int totalWeight = m_sharedWeight > 0 ? m_sharedWeight : runtime->stats.weight;
+        double pool = m_runtimeShare * static_cast<double>(m_periodMicroseconds);
+        return (std::max)(int64_t(1), static_cast<int64_t>(pool * runtime->stats.weight / totalWeight));
+    }
+
+    /**
+     * @brief Recomputes the sum of the weights of the runtimes without explicit budget.
+     */
+    void updateSharedWeight() {
+        m_sharedWeight = 0;
+        for (const auto& entry : m_runtimes) {
+            if (!entry.second->stopped && entry.second->explicitBudget == 0) {
+                m_sharedWeight += entry.second->stats.weight;
+            }
+        }
+    }
+
+    void rollPeriod(TimePoint now) {
+        if (now < m_periodEnd) {
+            return;
+        }
+        for (auto& entry : m_runtimes) {
+            Runtime* runtime = entry.second;
+            int64_t budget = budgetOf(runtime);
+            runtime->consumedLastPeriod = runtime->consumed;
+            // Le dépassement est reporté (au plus une période) : une tranche trop longue se paie ensuite
+            int64_t debt = runtime->consumed > budget ? runtime->consumed - budget : 0;
+            runtime->consumed = (std::min)(debt, m_periodMicroseconds);
+        }
+        m_periodEnd = now + std::chrono::microseconds(m_periodMicroseconds);
+    }
+
+    int64_t m_periodMicroseconds; ///< Length of an accounting period.
+    double m_runtimeShare; ///< Fraction of a period shared by the runtimes.
+    int m_nextId; ///< Identifier of the next runtime.
+    int m_sharedWeight = 0; ///< Sum of the weights of the runtimes sharing the pool.
+    TimePoint m_periodEnd; ///< End of the current period.
+    std::map<int, Runtime*> m_runtimes; ///< Installed runtimes, by identifier.
+};
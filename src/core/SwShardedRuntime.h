@@ -0,0 +1,314 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include "SwCoreApplication.h"
+
+#if !defined(_WIN32)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+
+/**
+ * @class SwShardedRuntime
+ * @brief Runs N independent event loops, one per thread, to use several cores in one process.
+ *
+ * Each loop is a full `SwCoreApplication` owned by its thread: it has its own timers, fibers,
+ * event queue and reactor, and nothing is shared between loops on the hot path. Code running in a
+ * loop keeps using `SwCoreApplication::instance()`, `SwTimer`, `SwEventLoop::swsleep`... which
+ * all resolve to the loop of the calling thread.
+ *
+ * ### Key Features:
+ * - Optional CPU pinning: loop `i` is bound to CPU `firstCpu + i` (`pthread_setaffinity_np` on
+ *   Linux, `SetThreadAffinityMask` on Windows).
+ * - `postTo(index, fn)` posts to a given loop, `post(fn)` spreads work round-robin.
+ * - `currentLoop()` / `currentIndex()` tell a callback which loop it runs on.
+ *
+ * ### Example:
+ * ```cpp
+ * SwShardedRuntime runtime(4, true); // 4 loops pinned to CPUs 0..3
+ * runtime.start();
+ * for (int i = 0; i < 1000; ++i) {
+ *     runtime.post([i]() {
+ *         // runs on one of the 4 loops, may use SwTimer, swsleep, sockets...
+ *     });
+ * }
+ * runtime.stop();
+ * ```
+ *
+ * ### Scaling a server:
+ * Give each loop its own `SwTcpServer` (started with `postTo(i, ...)`) or accept on one loop and
+ * hand every accepted connection to `post()`. A connection must then stay on the loop it was
+ * handed to.
+ *
+ * @warning Objects created inside a loop (timers, sockets) belong to that loop's thread and must
+ *          only be used from it. Use `postTo` to talk to them from elsewhere.
+ */
+class SwShardedRuntime {
+public:
+    /**
+     * @brief Constructs a stopped runtime.
+     * @param loopCount Number of loops, `0` for one per hardware thread.
+     * @param pinThreads If `true`, loop `i` is pinned to CPU `firstCpu + i`.
+     * @param firstCpu First CPU used when pinning.
+     */
+    explicit SwShardedRuntime(int loopCount = 0, bool pinThreads = false, int firstCpu = 0)
+        : m_loopCount(loopCount > 0 ? loopCount : (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()))),
+          m_pinThreads(pinThreads),
+          m_firstCpu(firstCpu),
+          m_nextLoop(0)
+    {}
+
+    /**
+     * @brief Stops the loops and joins their threads.
+     */
+    ~SwShardedRuntime() {
+        stop();
+    }
+
+    SwShardedRuntime(const SwShardedRuntime&) = delete;
+    SwShardedRuntime& operator=(const SwShardedRuntime&) = delete;
+
+    /**
+     * @brief Sets a function run on each loop thread before its loop starts (thread name, ...).
+     * @param initializer Called with the loop index, on the loop thread.
+     */
+    void setThreadInitializer(std::function<void(int)> initializer) {
+        m_initializer = initializer;
+    }
+
+    /**
+     * @brief Starts the loop threads and waits until every loop accepts events.
+     */
+    void start() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_threads.empty()) {
+            return;
+        }
+        m_loops.assign(m_loopCount, LoopSlot());
+        m_readyCount = 0;
+        for (int i = 0; i < m_loopCount; ++i) {
+            m_threads.emplace_back(&SwShardedRuntime::threadMain, this, i);
+        }
+        m_readyCondition.wait(lock, [this]() { return m_readyCount == m_loopCount; });
+    }
+
+    /**
+     * @brief Asks every loop to quit and joins the threads. Events still queued are dropped.
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const LoopSlot& slot : m_loops) {
+                if (slot.loop) {
+                    slot.loop->quit();
+                }
+            }
+        }
+        for (std::thread& thread : m_threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        m_threads.clear();
+        // Chaque thread a vidé son emplacement et attendu ses producteurs : on peut réduire le vecteur
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_loops.clear();
+    }
+
+    /**
+     * @brief Returns `true` between `start()` and `stop()`.
+     */
+    bool isRunning() const {
+        return !m_threads.empty();
+    }
+
+    int loopCount() const {
+        return m_loopCount;
+    }
+
+    /**
+     * @brief Returns loop `index`, or `nullptr` if the runtime is not started.
+     *
+     * The pointer stays valid until `stop()`. To talk to a loop from another thread, prefer
+     * `postTo`, which keeps the loop alive during the post.
+     */
+    SwCoreApplication* loop(int index) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (index < 0 || index >= static_cast<int>(m_loops.size())) {
+            return nullptr;
+        }
+        return m_loops[index].loop;
+    }
+
+    /**
+     * @brief Posts an event to loop `index`. Safe from any thread.
+     * @return `false` if the index is invalid, the runtime is not started or the overload policy
+     *         of the loop refused the event.
+     */
+    template<typename Callable>
+    bool postTo(int index, Callable&& event, ExecutionHint hint = ExecutionHint::Fiber) {
+        SwCoreApplication* target = acquireLoop(index);
+        if (!target) {
+            std::cerr << "[SwShardedRuntime] postTo: no loop at index " << index << std::endl;
+            return false;
+        }
+        bool posted = target->postEvent(std::forward<Callable>(event), hint);
+        releaseLoop(index);
+        return posted;
+    }
+
+    /**
+     * @brief Posts an event to the next loop in round-robin order. Safe from any thread.
+     * @return The index of the loop that received the event, or `-1` if the runtime is not started
+     *         or the loop refused the event.
+     */
+    template<typename Callable>
+    int post(Callable&& event, ExecutionHint hint = ExecutionHint::Fiber) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_loops.empty()) {
+                return -1;
+            }
+        }
+        int index = static_cast<int>(m_nextLoop.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned int>(m_loopCount));
+        return postTo(index, std::forward<Callable>(event), hint) ? index : -1;
+    }
+
+    /**
+     * @brief Returns the loop running the calling code, or `nullptr` outside of any loop.
+     */
+    static SwCoreApplication* currentLoop() {
+        return SwCoreApplication::currentLoop();
+    }
+
+    /**
+     * @brief Returns the index of the runtime loop running the calling code, or `-1`.
+     */
+    static int currentIndex() {
+        return currentIndexRef();
+    }
+
+    /**
+     * @brief Pins the calling thread to one CPU.
+     * @return `true` on success.
+     */
+    static bool pinCurrentThread(int cpu) {
+#if defined(_WIN32)
+        DWORD_PTR mask = static_cast<DWORD_PTR>(1) << cpu;
+        if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+            std::cerr << "[SwShardedRuntime] SetThreadAffinityMask failed for CPU " << cpu << ". Error: " << GetLastError() << std::endl;
+            return false;
+        }
+        return true;
+#else
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (result != 0) {
+            std::cerr << "[SwShardedRuntime] pthread_setaffinity_np failed for CPU " << cpu << ". Error: " << result << std::endl;
+            return false;
+        }
+        return true;
+#endif
+    }
+
+private:
+    /**
+     * @brief A loop and the posts in progress towards it, both guarded by `m_mutex`.
+     */
+    struct LoopSlot {
+        SwCoreApplication* loop = nullptr;
+        int inFlight = 0; ///< `postTo` calls using `loop`; the loop is destroyed only once it drops to 0.
+    };
+
+    /**
+     * @brief Returns loop `index` and keeps it alive until `releaseLoop`, or `nullptr`.
+     */
+    SwCoreApplication* acquireLoop(int index) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (index < 0 || index >= static_cast<int>(m_loops.size()) || !m_loops[index].loop) {
+            return nullptr;
+        }
+        ++m_loops[index].inFlight;
+        return m_loops[index].loop;
+    }
+
+    void releaseLoop(int index) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_loops[index].inFlight == 0) {
+            m_drainedCondition.notify_all();
+        }
+    }
+
+    static int& currentIndexRef() {
+        static thread_local int s_index = -1;
+        return s_index;
+    }
+
+    void threadMain(int index) {
+        if (m_pinThreads) {
+            pinCurrentThread(m_firstCpu + index);
+        }
+        currentIndexRef() = index;
+        if (m_initializer) {
+            m_initializer(index);
+        }
+
+        SwCoreApplication loop{SwCoreApplication::SecondaryLoopTag()};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_loops[index].loop = &loop;
+            ++m_readyCount;
+        }
+        m_readyCondition.notify_all();
+
+        loop.exec();
+
+        // Les producteurs bloqués par la politique de débordement sont libérés avant l'attente
+        loop.setEventQueueCapacity(0);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_loops[index].loop = nullptr;
+        // La boucle est un objet de pile : elle ne disparaît qu'une fois les postTo en cours terminés
+        m_drainedCondition.wait(lock, [this, index]() { return m_loops[index].inFlight == 0; });
+    }
+
+    int m_loopCount; ///< Number of loops (and threads).
+    bool m_pinThreads; ///< Pin loop `i` to CPU `m_firstCpu + i`.
+    int m_firstCpu; ///< First CPU used when pinning.
+    std::atomic<unsigned int> m_nextLoop; ///< Round-robin cursor of `post()`.
+    std::function<void(int)> m_initializer; ///< Optional per-thread initialisation.
+    std::vector<std::thread> m_threads; ///< Loop threads.
+    std::vector<LoopSlot> m_loops; ///< Loop of each thread, `nullptr` once it has exited.
+    mutable std::mutex m_mutex; ///< Protects `m_loops` and `m_readyCount`.
+    std::condition_variable m_readyCondition; ///< Signalled when a loop is ready.
+    std::condition_variable m_drainedCondition; ///< Signalled when the posts towards a loop have drained.
+    int m_readyCount = 0; ///< Number of loops accepting events.
+};
@@ -0,0 +1,679 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+/**
+ * C++20 coroutines for the event loop, enabled by defining `SW_ENABLE_COROUTINES` (and compiling
+ * in C++20). Without the macro this header is empty and the C++11 build is unaffected.
+ */
+#if defined(SW_ENABLE_COROUTINES)
+
+#if !defined(__cpp_impl_coroutine)
+    #error "SW_ENABLE_COROUTINES requires a C++20 compiler with coroutine support"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "SwCoreApplication.h"
+#include "SwCoroutineFrameAllocator.h"
+#include "SwEventDispatcher.h"
+#include "SwFuture.h"
+#include "SwObject.h"
+
+template<typename T> class SwTask;
+
+
+/**
+ * @brief Part of the promise shared by every `SwTask`: frame allocation, start state,
+ *        continuation and exception.
+ */
+class SwTaskPromiseBase {
+public:
+    static void* operator new(std::size_t size) {
+        return SwCoroutineFrameAllocator::allocate(size);
+    }
+
+    static void operator delete(void* frame, std::size_t size) {
+        SwCoroutineFrameAllocator::deallocate(frame, size);
+    }
+
+    /**
+     * @brief Resumes the awaiting coroutine, or frees the frame of a detached task.
+     */
+    struct FinalAwaiter {
+        bool await_ready() noexcept {
+            return false;
+        }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            SwTaskPromiseBase& promise = handle.promise();
+            if (promise.m_continuation) {
+                return promise.m_continuation;
+            }
+            if (promise.m_detached) {
+                if (promise.m_exception) {
+                    std::cerr << "[SwTask] Detached task ended with an exception" << std::endl;
+                }
+                handle.destroy();
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() noexcept {
+        return {};
+    }
+
+    void unhandled_exception() {
+        m_exception = std::current_exception();
+    }
+
+protected:
+    template<typename U> friend class SwTask;
+
+    void rethrowIfFailed() {
+        if (m_exception) {
+            std::rethrow_exception(m_exception);
+        }
+    }
+
+    std::coroutine_handle<> m_continuation; ///< Coroutine awaiting this task, resumed when it ends.
+    std::exception_ptr m_exception; ///< Exception escaped from the coroutine body.
+    bool m_started = false; ///< The body has been entered (tasks start lazily).
+    bool m_detached = false; ///< Nobody owns the frame: it frees itself when the body ends.
+};
+
+template<typename T>
+class SwTaskPromise : public SwTaskPromiseBase {
+public:
+    SwTask<T> get_return_object();
+
+    template<typename U>
+    void return_value(U&& value) {
+        m_value.emplace(std::forward<U>(value));
+    }
+
+    T takeResult() {
+        rethrowIfFailed();
+        return std::move(*m_value);
+    }
+
+private:
+    std::optional<T> m_value; ///< Value given to `co_return`.
+};
+
+template<>
+class SwTaskPromise<void> : public SwTaskPromiseBase {
+public:
+    SwTask<void> get_return_object();
+
+    void return_void() {}
+
+    void takeResult() {
+        rethrowIfFailed();
+    }
+};
+
+
+/**
+ * @class SwTask
+ * @brief Stackless coroutine running on the event loop, an alternative to fibers for I/O-bound work.
+ *
+ * A coroutine returning `SwTask<T>` suspends with `co_await` and is resumed by the event loop:
+ * only its frame (usually a few hundred bytes, recycled by `SwCoroutineFrameAllocator`) stays
+ * alive while it waits, instead of a whole fiber stack, so millions of operations can be in
+ * flight at once.
+ *
+ * ### Awaitables:
+ * - another `SwTask` (the awaited task starts right away and resumes the caller when it ends),
+ * - `SwCoroutines::delay(ms)`, a single-shot timer,
+ * - `SwCoroutines::readable(fd)` / `writable(fd)`, descriptor readiness,
+ * - a `SwFuture<T>`,
+ * - `SwCoroutines::signal<Args...>(sender, SIGNAL(name))`, the next emission of a signal.
+ *
+ * Tasks start lazily: `co_await` them, `start()` them while keeping the `SwTask`, `detach()` them
+ * (the frame frees itself at the end) or convert them with `toFuture()`. A task resumes on the
+ * event loop of the thread it was suspended on, inline: its body must `co_await` rather than call
+ * blocking functions. Destroying a suspended task cancels its pending timer or descriptor watch.
+ *
+ * ### Example:
+ * ```cpp
+ * SwTask<int> fetch(int fd) {
+ *     co_await SwCoroutines::delay(10);
+ *     int events = co_await SwCoroutines::readable(fd);
+ *     co_return events;
+ * }
+ *
+ * SwTask<> session(int fd) {
+ *     int events = co_await fetch(fd);
+ *     SwString reply = co_await backend.query(events); // SwFuture<SwString>
+ * }
+ *
+ * session(fd).detach();
+ * ```
+ *
+ * @note Requires `SW_ENABLE_COROUTINES` and a C++20 compiler.
+ */
+template<typename T = void>
+class SwTask {
+public:
+    typedef SwTaskPromise<T> promise_type;
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    /**
+     * @brief Awaiter returned by `co_await task`.
+     */
+    class Awaiter {
+    public:
+        explicit Awaiter(Handle handle)
+            : m_handle(handle)
+        {}
+
+        bool await_ready() const noexcept {
+            return m_handle.done();
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            promise_type& promise = m_handle.promise();
+            promise.m_continuation = awaiting;
+            if (promise.m_started) {
+                return std::noop_coroutine(); // déjà lancée par start() : elle reprendra l'appelant
+            }
+            promise.m_started = true;
+            return m_handle;
+        }
+
+        T await_resume() {
+            return m_handle.promise().takeResult();
+        }
+
+    private:
+        Handle m_handle;
+    };
+
+    SwTask() = default;
+
+    explicit SwTask(Handle handle)
+        : m_handle(handle)
+    {}
+
+    SwTask(SwTask&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, Handle()))
+    {}
+
+    SwTask& operator=(SwTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_handle = std::exchange(other.m_handle, Handle());
+        }
+        return *this;
+    }
+
+    SwTask(const SwTask&) = delete;
+    SwTask& operator=(const SwTask&) = delete;
+
+    /**
+     * @brief Destroys the coroutine frame, cancelling what a suspended task was waiting for.
+     */
+    ~SwTask() {
+        reset();
+    }
+
+    bool isValid() const {
+        return static_cast<bool>(m_handle);
+    }
+
+    bool isDone() const {
+        return m_handle && m_handle.done();
+    }
+
+    /**
+     * @brief Runs the task until its first suspension. The `SwTask` must outlive it.
+     */
+    void start() {
+        if (m_handle && !m_handle.promise().m_started) {
+            m_handle.promise().m_started = true;
+            m_handle.resume();
+        }
+    }
+
+    /**
+     * @brief Starts the task (if needed) and gives up ownership: the frame frees itself at the end.
+     *
+     * An exception escaping a detached task is reported on `std::cerr`.
+     */
+    void detach() {
+        if (!m_handle) {
+            return;
+        }
+        Handle handle = std::exchange(m_handle, Handle());
+        promise_type& promise = handle.promise();
+        if (handle.done()) {
+            handle.destroy();
+            return;
+        }
+        promise.m_detached = true;
+        if (!promise.m_started) {
+            promise.m_started = true;
+            handle.resume();
+        }
+    }
+
+    /**
+     * @brief Returns the result of a finished task, or rethrows its exception.
+     */
+    T result() {
+        return m_handle.promise().takeResult();
+    }
+
+    /**
+     * @brief Detaches the task and returns a future of its result, for fiber or thread code.
+     */
+    SwFuture<T> toFuture() && {
+        SwPromise<T> promise;
+        SwFuture<T> future = promise.future();
+        forward(std::move(*this), promise, std::is_void<T>()).detach();
+        return future;
+    }
+
+    Awaiter operator co_await() && noexcept {
+        return Awaiter(m_handle);
+    }
+
+    Awaiter operator co_await() & noexcept {
+        return Awaiter(m_handle);
+    }
+
+private:
+    void reset() {
+        if (m_handle) {
+            m_handle.destroy();
+            m_handle = Handle();
+        }
+    }
+
+    static SwTask<void> forward(SwTask task, SwPromise<T> promise, std::false_type) {
+        try {
+            promise.setValue(co_await std::move(task));
+        } catch (...) {
+            promise.setException(std::current_exception());
+        }
+    }
+
+    static SwTask<void> forward(SwTask task, SwPromise<T> promise, std::true_type) {
+        try {
+            co_await std::move(task);
+            promise.setValue();
+        } catch (...) {
+            promise.setException(std::current_exception());
+        }
+    }
+
+    Handle m_handle; ///< Frame owned by this task.
+};
+
+template<typename T>
+SwTask<T> SwTaskPromise<T>::get_return_object() {
+    return SwTask<T>(SwTask<T>::Handle::from_promise(*this));
+}
+
+inline SwTask<void> SwTaskPromise<void>::get_return_object() {
+    return SwTask<void>(SwTask<void>::Handle::from_promise(*this));
+}
+
+
+/**
+ * @brief Awaiter of `SwCoroutines::delay`: a single-shot timer of the current event loop that
+ *        resumes the coroutine inline.
+ */
+class SwDelayAwaiter {
+public:
+    explicit SwDelayAwaiter(int ms)
+        : m_ms(ms)
+    {}
+
+    SwDelayAwaiter(SwDelayAwaiter&&) = default;
+
+    ~SwDelayAwaiter() {
+        if (m_timerId >= 0) {
+            m_app->removeTimer(m_timerId); // frame détruit avant l'échéance
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        m_app = SwCoreApplication::instance();
+        m_handle = handle;
+        m_timerId = m_app->addTimer([this]() {
+            m_timerId = -1;
+            m_handle.resume();
+        }, m_ms * 1000, true, ExecutionHint::Inline);
+    }
+
+    void await_resume() noexcept {}
+
+private:
+    int m_ms; ///< Delay in milliseconds.
+    int m_timerId = -1; ///< Armed timer, `-1` once fired.
+    SwCoreApplication* m_app = nullptr; ///< Loop owning the timer.
+    std::coroutine_handle<> m_handle; ///< Suspended coroutine.
+};
+
+
+/**
+ * @brief Awaiter of `SwCoroutines::readable` / `writable` / `ready`: watches a descriptor with
+ *        `registerDescriptor` until it becomes ready, then returns the ready flags.
+ *
+ * A descriptor can only be watched once at a time; if the registration fails, the coroutine does
+ * not suspend and gets `SwEventDispatcher::ErrorEvent`.
+ */
+class SwDescriptorAwaiter {
+public:
+    SwDescriptorAwaiter(SwEventDispatcher::Descriptor descriptor, int events)
+        : m_descriptor(descriptor),
+          m_events(events)
+    {}
+
+    SwDescriptorAwaiter(SwDescriptorAwaiter&&) = default;
+
+    ~SwDescriptorAwaiter() {
+        if (m_id >= 0) {
+            m_app->unregisterDescriptor(m_id);
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        m_app = SwCoreApplication::instance();
+        m_handle = handle;
+        m_id = m_app->registerDescriptor(m_descriptor, m_events, [this](int events) {
+            m_app->unregisterDescriptor(m_id);
+            m_id = -1;
+            m_readyEvents = events;
+            m_handle.resume();
+        });
+        if (m_id < 0) {
+            m_readyEvents = SwEventDispatcher::ErrorEvent;
+            return false;
+        }
+        return true;
+    }
+
+    int await_resume() noexcept {
+        return m_readyEvents;
+    }
+
+private:
+    SwEventDispatcher::Descriptor m_descriptor; ///< Watched descriptor.
+    int m_events; ///< `SwEventDispatcher::DescriptorEvent` flags to wait for.
+    int m_id = -1; ///< Registration identifier, `-1` when not registered.
+    int m_readyEvents = 0; ///< Flags reported by the dispatcher.
+    SwCoreApplication* m_app = nullptr; ///< Loop watching the descriptor.
+    std::coroutine_handle<> m_handle; ///< Suspended coroutine.
+};
+
+
+/**
+ * @brief Coroutine suspended on a completion reported from any thread (future, signal).
+ *
+ * Shared with the completion callback, which posts the resumption to `app`; the awaiter clears
+ * `handle` if the frame is destroyed first. Only touched on the loop thread.
+ */
+struct SwCoroutineWakeup {
+    std::coroutine_handle<> handle; ///< Suspended coroutine, empty once resumed or destroyed.
+    SwCoreApplication* app = nullptr; ///< Loop the coroutine resumes on.
+
+    static void post(const std::shared_ptr<SwCoroutineWakeup>& wakeup) {
+        wakeup->app->postEventUnbounded([wakeup]() {
+            if (wakeup->handle) {
+                std::exchange(wakeup->handle, std::coroutine_handle<>()).resume();
+            }
+        }, ExecutionHint::Inline);
+    }
+};
+
+
+/**
+ * @brief Awaiter of a `SwFuture<T>`: the coroutine resumes on its event loop once the result is
+ *        set, from any thread, and gets the result (or the exception).
+ */
+template<typename T>
+class SwFutureAwaiter {
+public:
+    explicit SwFutureAwaiter(SwFuture<T> future)
+        : m_future(std::move(future))
+    {}
+
+    SwFutureAwaiter(SwFutureAwaiter&&) = default;
+
+    ~SwFutureAwaiter() {
+        if (m_wakeup) {
+            m_wakeup->handle = std::coroutine_handle<>();
+        }
+    }
+
+    bool await_ready() const {
+        return m_future.isReady();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        m_wakeup = std::make_shared<SwCoroutineWakeup>();
+        m_wakeup->handle = handle;
+        m_wakeup->app = SwCoreApplication::instance();
+        std::shared_ptr<SwCoroutineWakeup> wakeup = m_wakeup;
+        m_future.onReady([wakeup]() {
+            SwCoroutineWakeup::post(wakeup);
+        });
+    }
+
+    T await_resume() {
+        return m_future.await();
+    }
+
+private:
+    SwFuture<T> m_future; ///< Awaited future.
+    std::shared_ptr<SwCoroutineWakeup> m_wakeup; ///< Set while suspended.
+};
+
+template<typename T>
+SwFutureAwaiter<T> operator co_await(SwFuture<T> future) {
+    return SwFutureAwaiter<T>(std::move(future));
+}
+
+
+/**
+ * @brief Value produced by `co_await` on a signal: nothing, the argument, or a tuple of them.
+ */
+template<typename... Args>
+struct SwSignalResult {
+    typedef std::tuple<Args...> Type;
+
+    static Type make(std::tuple<Args...>&& values) {
+        return std::move(values);
+    }
+};
+
+template<typename A>
+struct SwSignalResult<A> {
+    typedef A Type;
+
+    static Type make(std::tuple<A>&& values) {
+        return std::get<0>(std::move(values));
+    }
+};
+
+template<>
+struct SwSignalResult<> {
+    typedef void Type;
+
+    static void make(std::tuple<>&&) {}
+};
+
+
+/**
+ * @brief Awaiter of `SwCoroutines::signal`: waits for the next emission of a signal.
+ *
+ * A temporary slot is connected while the coroutine waits; the emission, on any thread, only
+ * claims the wait and posts the arguments with the resumption, and the slot is then
+ * disconnected on the loop of the coroutine. `Args` are the decayed types
+ * the signal is emitted with. The sender must outlive the wait.
+ */
+template<typename... Args>
+class SwSignalAwaiter {
+public:
+    SwSignalAwaiter(SwObject* sender, const SwString& signalName)
+        : m_wait(std::make_shared<Wait>())
+    {
+        m_wait->sender = sender;
+        m_wait->signalName = signalName;
+    }
+
+    SwSignalAwaiter(SwSignalAwaiter&&) = default;
+
+    ~SwSignalAwaiter() {
+        if (m_wait) {
+            m_wait->handle = std::coroutine_handle<>();
+            m_wait->disconnect();
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        m_wait->handle = handle;
+        m_wait->app = SwCoreApplication::instance();
+        std::shared_ptr<Wait> wait = m_wait;
+        m_wait->slot = new SlotFunction<Args...>([wait](Args... args) {
+            // Le thread émetteur ne touche qu'à l'atomique : le reste de Wait appartient à la boucle
+            if (wait->fired.exchange(true, std::memory_order_acq_rel)) {
+                return;
+            }
+            // Reprise hors de l'émission : le slot peut alors être retiré de la connexion
+            wait->app->postEventUnbounded([wait, values = std::tuple<Args...>(args...)]() mutable {
+                wait->disconnect();
+                if (wait->handle) {
+                    wait->values.emplace(std::move(values));
+                    std::exchange(wait->handle, std::coroutine_handle<>()).resume();
+                }
+            }, ExecutionHint::Inline);
+        });
+        m_wait->sender->addConnection(m_wait->signalName, static_cast<ISlot<void, Args...>*>(m_wait->slot), DirectConnection);
+    }
+
+    typename SwSignalResult<Args...>::Type await_resume() {
+        return SwSignalResult<Args...>::make(std::move(*m_wait->values));
+    }
+
+private:
+    struct Wait {
+        std::coroutine_handle<> handle; ///< Suspended coroutine, empty once resumed or destroyed.
+        SwCoreApplication* app = nullptr; ///< Loop the coroutine resumes on.
+        SwObject* sender = nullptr; ///< Object emitting the signal.
+        SwString signalName; ///< Awaited signal.
+        SlotFunction<Args...>* slot = nullptr; ///< Temporary connection, `nullptr` once removed.
+        std::atomic<bool> fired{false}; ///< Claimed by the first emission, from the emitting thread.
+        std::optional<std::tuple<Args...>> values; ///< Arguments of the emission, set on the loop.
+
+        void disconnect() {
+            if (slot) {
+                sender->removeConnection(signalName, static_cast<ISlot<void, Args...>*>(slot));
+                delete slot;
+                slot = nullptr;
+            }
+        }
+    };
+
+    std::shared_ptr<Wait> m_wait; ///< Shared with the temporary slot.
+};
+
+
+/**
+ * @class SwCoroutines
+ * @brief Factories of the event-loop awaitables usable in a `SwTask`.
+ */
+class SwCoroutines {
+public:
+    /**
+     * @brief Suspends the coroutine for `ms` milliseconds.
+     */
+    static SwDelayAwaiter delay(int ms) {
+        return SwDelayAwaiter(ms);
+    }
+
+    /**
+     * @brief Suspends the coroutine until `descriptor` is readable; returns the ready flags.
+     */
+    static SwDescriptorAwaiter readable(SwEventDispatcher::Descriptor descriptor) {
+        return SwDescriptorAwaiter(descriptor, SwEventDispatcher::ReadEvent);
+    }
+
+    /**
+     * @brief Suspends the coroutine until `descriptor` is writable (Linux); returns the ready flags.
+     */
+    static SwDescriptorAwaiter writable(SwEventDispatcher::Descriptor descriptor) {
+        return SwDescriptorAwaiter(descriptor, SwEventDispatcher::WriteEvent);
+    }
+
+    /**
+     * @brief Suspends the coroutine until one of `events` is reported for `descriptor`.
+     */
+    static SwDescriptorAwaiter ready(SwEventDispatcher::Descriptor descriptor, int events) {
+        return SwDescriptorAwaiter(descriptor, events);
+    }
+
+    /**
+     * @brief Suspends the coroutine until `sender` emits `signalName`; returns its arguments.
+     *
+     * ### Example:
+     * ```cpp
+     * int value = co_await SwCoroutines::signal<int>(spinBox, SIGNAL(valueChanged));
+     * ```
+     */
+    template<typename... Args>
+    static SwSignalAwaiter<Args...> signal(SwObject* sender, const SwString& signalName) {
+        return SwSignalAwaiter<Args...>(sender, signalName);
+    }
+};
+
+#endif // SW_ENABLE_COROUTINES
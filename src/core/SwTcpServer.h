@@ -31,6 +31,8 @@
 #include <ws2tcpip.h>
 #include <windows.h>
 #include <iostream>
+#include <atomic>
+#include <memory>
 
 #pragma comment(lib, "ws2_32.lib")
 
@@ -38,12 +40,10 @@ class SwTcpServer : public SwObject {
     SW_OBJECT(SwTcpServer, SwObject)
 public:
     SwTcpServer(SwObject* parent = nullptr)
-        : SwObject(parent), m_listenSocket(INVALID_SOCKET), m_listenEvent(NULL)
+        : SwObject(parent), m_listenSocket(INVALID_SOCKET), m_listenEvent(NULL), m_loop(nullptr),
+          m_listenDescriptorId(-1), m_acceptPaused(false), m_pauseOnOverload(true)
     {
         initializeWinsock();
-        m_timer = new SwTimer(50, this);
-        connect(m_timer, SIGNAL(timeout), this, &SwTcpServer::onCheckEvents);
-        m_timer->start();
     }
 
     virtual ~SwTcpServer() {
@@ -92,10 +92,60 @@ public:
             return false;
         }
 
+        // Les connexions sont acceptées sur la boucle d'affinité du serveur
+        m_loop = thread() ? thread() : SwCoreApplication::instance();
+        m_acceptPaused = false;
+        watchListenEvent();
+
+        // Tant que la boucle est surchargée, les connexions restent dans le backlog du noyau
+        std::shared_ptr<OverloadWatch> watch = std::make_shared<OverloadWatch>();
+        m_overloadWatch = watch;
+        std::function<void(bool)> handler = [this, watch](bool overloaded) {
+            if (!watch->active.load(std::memory_order_acquire) || !m_pauseOnOverload) {
+                return;
+            }
+            if (overloaded) {
+                pauseAccepting();
+            } else {
+                resumeAccepting();
+            }
+        };
+        if (SwCoreApplication::currentLoop() == m_loop) {
+            watch->handlerId = m_loop->addOverloadHandler(std::move(handler));
+        } else {
+            // La liste des handlers appartient au thread de la boucle : même file que le retrait de close()
+            SwCoreApplication* loop = m_loop;
+            loop->postEventUnbounded([loop, watch, handler]() {
+                if (watch->active.load(std::memory_order_acquire)) {
+                    watch->handlerId = loop->addOverloadHandler(handler);
+                }
+            }, ExecutionHint::Inline);
+        }
+
         return true;
     }
 
+    /**
+     * @brief Stops listening. Safe from any thread.
+     *
+     * The overload handler is disarmed at once; from another thread its removal is posted to the
+     * loop of the server.
+     */
     void close() {
+        if (m_overloadWatch) {
+            std::shared_ptr<OverloadWatch> watch = std::move(m_overloadWatch);
+            watch->active.store(false, std::memory_order_release);
+            if (SwCoreApplication::currentLoop() == m_loop) {
+                m_loop->removeOverloadHandler(watch->handlerId);
+            } else {
+                SwCoreApplication* loop = m_loop;
+                loop->postEventUnbounded([loop, watch]() {
+                    loop->removeOverloadHandler(watch->handlerId);
+                }, ExecutionHint::Inline);
+            }
+        }
+        unwatchListenEvent();
+        m_acceptPaused = false;
         if (m_listenSocket != INVALID_SOCKET) {
             closesocket(m_listenSocket);
             m_listenSocket = INVALID_SOCKET;
@@ -106,6 +156,46 @@ public:
         }
     }
 
+    /**
+     * @brief Stops accepting connections; new clients wait in the listen backlog.
+     */
+    void pauseAccepting() {
+        if (m_listenSocket == INVALID_SOCKET || m_acceptPaused) {
+            return;
+        }
+        m_acceptPaused = true;
+        unwatchListenEvent();
+    }
+
+    /**
+     * @brief Accepts connections again, starting with the ones queued in the backlog.
+     */
+    void resumeAccepting() {
+        if (m_listenSocket == INVALID_SOCKET || !m_acceptPaused) {
+            return;
+        }
+        m_acceptPaused = false;
+        watchListenEvent();
+    }
+
+    bool isAccepting() const {
+        return m_listenSocket != INVALID_SOCKET && !m_acceptPaused;
+    }
+
+    /**
+     * @brief Whether accepting pauses while the event loop is overloaded (enabled by default).
+     *
+     * The server follows the loop watermarks (`SwCoreApplication::setEventQueueWatermarks`):
+     * it calls `pauseAccepting()` when the loop reports an overload and `resumeAccepting()` once
+     * it has recovered.
+     */
+    void setPauseAcceptingOnOverload(bool enabled) {
+        m_pauseOnOverload = enabled;
+        if (!enabled) {
+            resumeAccepting();
+        }
+    }
+
     SwTcpSocket* nextPendingConnection() {
         if (m_pendingConnections.isEmpty()) {
             return nullptr;
@@ -159,9 +249,21 @@ private slots:
     }
 
 private:
+    /**
+     * @brief State shared with the overload handler, which may outlive `close()` by one post.
+     */
+    struct OverloadWatch {
+        std::atomic<bool> active{true}; ///< Cleared by `close()`; a disarmed handler does nothing.
+        int handlerId = -1; ///< Identifier of the handler in the loop, only used on that loop's thread.
+    };
+
     SOCKET m_listenSocket;
     WSAEVENT m_listenEvent;
-    SwTimer* m_timer;
+    SwCoreApplication* m_loop; ///< Loop the server listens on: `thread()`, or `instance()` without affinity.
+    int m_listenDescriptorId; ///< Registration of m_listenEvent in the event loop reactor.
+    std::shared_ptr<OverloadWatch> m_overloadWatch; ///< Overload handler of the listening server, `nullptr` when closed.
+    bool m_acceptPaused; ///< Set by `pauseAccepting()`.
+    bool m_pauseOnOverload; ///< Follow the overload state of the loop.
     SwList<SwTcpSocket*> m_pendingConnections;
 
     static void initializeWinsock() {
@@ -177,6 +279,22 @@ private:
         }
     }
 
+    void watchListenEvent() {
+        if (m_listenDescriptorId != -1) {
+            return;
+        }
+        // Le réacteur de la boucle nous réveille dès qu'une connexion arrive ; sûr depuis tout thread
+        m_listenDescriptorId = m_loop->registerDescriptor(
+            m_listenEvent, SwEventDispatcher::ReadEvent, [this](int) { onCheckEvents(); });
+    }
+
+    void unwatchListenEvent() {
+        if (m_listenDescriptorId != -1) {
+            m_loop->unregisterDescriptor(m_listenDescriptorId);
+            m_listenDescriptorId = -1;
+        }
+    }
+
     SwTcpSocket* createSocketFromHandle(SOCKET sock) {
         SwTcpSocket* client = new SwTcpSocket();
         client->adoptSocket(sock);
@@ -60,8 +60,8 @@ public:
     /**
      * @brief Constructs a `SwTcpSocket` object and initializes Winsock.
      *
-     * This constructor sets up the TCP socket object with default values, initializes the Winsock library,
-     * and starts monitoring for socket events.
+     * This constructor sets up the TCP socket object with default values and initializes the Winsock
+     * library. Socket events are watched once a socket exists (`connectToHost`, `adoptSocket`).
      *
      * @param parent A pointer to the parent object. Defaults to `nullptr`.
      *
@@ -69,9 +69,8 @@ public:
      * @warning Ensure that the parent object properly manages the lifecycle of this socket.
      */
     SwTcpSocket(SwObject* parent = nullptr)
-        : SwAbstractSocket(parent), m_socket(INVALID_SOCKET), m_event(NULL) {
+        : SwAbstractSocket(parent), m_socket(INVALID_SOCKET), m_event(NULL), m_eventDescriptorId(-1) {
         initializeWinsock();
-        startMonitoring();
     }
 
     /**
@@ -146,6 +145,7 @@ public:
             close();
             return false;
         }
+        watchSocketEvent();
 
         // Résolution du nom d'hôte
         std::string hostAnsi = host.toStdString();
@@ -235,6 +235,10 @@ public:
             closesocket(m_socket);
             m_socket = INVALID_SOCKET;
         }
+        if (m_eventDescriptorId != -1) {
+            SwCoreApplication::instance()->unregisterDescriptor(m_eventDescriptorId);
+            m_eventDescriptorId = -1;
+        }
         if (m_event) {
             WSACloseEvent(m_event);
             m_event = NULL;
@@ -436,9 +440,9 @@ public:
 
             m_event = WSACreateEvent();
             WSAEventSelect(m_socket, m_event, FD_READ | FD_WRITE | FD_CLOSE);
+            watchSocketEvent();
 
             setState(ConnectedState);
-            startMonitoring();
             emit connected();
         }
     }
@@ -454,8 +458,8 @@ protected:
      * - Calls the base class `onTimerDescriptor` for standard descriptor management.
      * - Invokes `checkSocketEvents` to process pending network events for the socket.
      *
-     * @note This method is part of the event loop and is called periodically to handle
-     *       socket-related updates.
+     * @note The timer only runs while `m_event` could not be registered with the event loop
+     *       reactor; see `watchSocketEvent`.
      */
     void onTimerDescriptor() override {
         SwIODevice::onTimerDescriptor();
@@ -465,6 +469,7 @@ protected:
 private:
     SOCKET m_socket;               ///< The Winsock socket handle used for TCP communication.
     WSAEVENT m_event;              ///< The event handle used for monitoring socket events.
+    int m_eventDescriptorId;       ///< Registration of `m_event` in the event loop reactor, or -1.
     std::string m_writeBuffer;     ///< Internal buffer to store data for partial writes in non-blocking mode.
 
     /**
@@ -493,6 +498,25 @@ private:
         }
     }
 
+    /**
+     * @brief Registers the socket event handle with the event loop reactor.
+     *
+     * Network events are then handled as soon as `m_event` is signaled, and the 100 ms monitoring
+     * timer is stopped. It is only armed as a fallback when the registration fails.
+     */
+    void watchSocketEvent() {
+        if (m_eventDescriptorId == -1 && m_event) {
+            m_eventDescriptorId = SwCoreApplication::instance()->registerDescriptor(
+                m_event, SwEventDispatcher::ReadEvent, [this](int) { checkSocketEvents(); });
+        }
+        if (m_eventDescriptorId != -1) {
+            stopMonitoring();
+        } else {
+            std::cerr << "[SwTcpSocket] Reactor registration failed, falling back to polling." << std::endl;
+            startMonitoring();
+        }
+    }
+
     /**
      * @brief Checks and processes pending socket events.
      *
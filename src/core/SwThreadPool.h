@@ -0,0 +1,229 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+
+/**
+ * @class SwThreadPool
+ * @brief Bounded pool of worker threads for blocking or CPU-heavy work that must not run on an
+ *        event loop (file hashing, large copies, DNS, heavy parsing...).
+ *
+ * Threads are started on demand, up to `maxThreadCount()`, and then stay alive waiting for work.
+ * Jobs run in submission order. The queue holds at most `maxQueueDepth()` waiting jobs: beyond
+ * that `tryStart` refuses the job instead of letting the backlog grow without limit, so the
+ * caller can shed load or report the failure.
+ *
+ * ### Metrics:
+ * `stats()` reports the number of submitted, completed and rejected jobs, the current and peak
+ * queue depth, the active and started threads, and the time jobs spent queued and running.
+ *
+ * ### Example:
+ * ```cpp
+ * SwThreadPool::globalInstance()->tryStart([path]() {
+ *     SwFile(path).fileChecksum();
+ * });
+ * ```
+ *
+ * `SwConcurrent::run` wraps this with a `SwFuture` and delivers the result back to the event loop.
+ *
+ * @note The destructor waits for the queued jobs to finish.
+ */
+class SwThreadPool {
+public:
+    /**
+     * @brief Counters of a pool. Times are in microseconds.
+     */
+    struct Stats {
+        uint64_t submitted = 0;     ///< Jobs accepted by `tryStart`.
+        uint64_t completed = 0;     ///< Jobs that returned.
+        uint64_t rejected = 0;      ///< Jobs refused because the queue was full.
+        size_t queued = 0;          ///< Jobs currently waiting for a thread.
+        size_t peakQueued = 0;      ///< Highest `queued` seen.
+        int activeThreads = 0;      ///< Threads currently running a job.
+        int threadCount = 0;        ///< Threads started.
+        uint64_t totalWaitUs = 0;   ///< Sum of the time jobs spent queued.
+        uint64_t maxWaitUs = 0;     ///< Longest time a job spent queued.
+        uint64_t totalRunUs = 0;    ///< Sum of the time jobs spent running.
+    };
+
+    /**
+     * @brief Constructs a pool.
+     * @param maxThreadCount Maximum number of threads, `0` for one per hardware thread.
+     * @param maxQueueDepth Maximum number of waiting jobs, `0` for no limit.
+     */
+    explicit SwThreadPool(int maxThreadCount = 0, size_t maxQueueDepth = DefaultMaxQueueDepth)
+        : m_maxThreadCount(maxThreadCount > 0 ? maxThreadCount : (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()))),
+          m_maxQueueDepth(maxQueueDepth),
+          m_idleThreads(0),
+          m_stopping(false)
+    {}
+
+    ~SwThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_workAvailable.notify_all();
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    SwThreadPool(const SwThreadPool&) = delete;
+    SwThreadPool& operator=(const SwThreadPool&) = delete;
+
+    /**
+     * @brief Returns the process-wide pool used by `SwConcurrent::run`.
+     */
+    static SwThreadPool* globalInstance() {
+        static SwThreadPool pool;
+        return &pool;
+    }
+
+    /**
+     * @brief Queues `job`, starting a thread if none is idle and the limit allows it.
+     * @return `false` if the queue is full (or the pool is being destroyed); `job` is then dropped.
+     */
+    bool tryStart(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping || (m_maxQueueDepth > 0 && m_queue.size() >= m_maxQueueDepth)) {
+                ++m_stats.rejected;
+                return false;
+            }
+            m_queue.push_back(Job{std::move(job), std::chrono::steady_clock::now()});
+            ++m_stats.submitted;
+            m_stats.peakQueued = (std::max)(m_stats.peakQueued, m_queue.size());
+            if (m_idleThreads < static_cast<int>(m_queue.size()) && static_cast<int>(m_threads.size()) < m_maxThreadCount) {
+                m_threads.push_back(std::thread([this]() { workerLoop(); }));
+            }
+        }
+        m_workAvailable.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Blocks until the queue is empty and no job is running.
+     */
+    void waitForDone() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_allDone.wait(lock, [this]() { return m_queue.empty() && m_stats.activeThreads == 0; });
+    }
+
+    int maxThreadCount() const {
+        return m_maxThreadCount;
+    }
+
+    /**
+     * @brief Sets the maximum number of threads. Threads already started are kept.
+     */
+    void setMaxThreadCount(int count) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxThreadCount = (std::max)(1, count);
+    }
+
+    size_t maxQueueDepth() const {
+        return m_maxQueueDepth;
+    }
+
+    /**
+     * @brief Sets the maximum number of waiting jobs, `0` for no limit.
+     */
+    void setMaxQueueDepth(size_t depth) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxQueueDepth = depth;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats current = m_stats;
+        current.queued = m_queue.size();
+        current.threadCount = static_cast<int>(m_threads.size());
+        return current;
+    }
+
+    static const size_t DefaultMaxQueueDepth = 65536; ///< Default limit of waiting jobs.
+
+private:
+    struct Job {
+        std::function<void()> function;
+        std::chrono::steady_clock::time_point enqueued; ///< Used for the wait-time metrics.
+    };
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            ++m_idleThreads;
+            m_workAvailable.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            --m_idleThreads;
+            if (m_queue.empty()) {
+                return; // arrêt demandé et plus rien à exécuter
+            }
+            Job job = std::move(m_queue.front());
+            m_queue.pop_front();
+            ++m_stats.activeThreads;
+            lock.unlock();
+
+            auto start = std::chrono::steady_clock::now();
+            try {
+                job.function();
+            } catch (const std::exception& ex) {
+                std::cerr << "[SwThreadPool] Job threw an exception: " << ex.what() << std::endl;
+            } catch (...) {
+                std::cerr << "[SwThreadPool] Job threw an unknown exception" << std::endl;
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            lock.lock();
+            uint64_t waitUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(start - job.enqueued).count());
+            m_stats.totalWaitUs += waitUs;
+            m_stats.maxWaitUs = (std::max)(m_stats.maxWaitUs, waitUs);
+            m_stats.totalRunUs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+            ++m_stats.completed;
+            --m_stats.activeThreads;
+            if (m_queue.empty() && m_stats.activeThreads == 0) {
+                m_allDone.notify_all();
+            }
+        }
+    }
+
+    mutable std::mutex m_mutex; ///< Protects every field below.
+    std::condition_variable m_workAvailable; ///< Wakes idle workers.
+    std::condition_variable m_allDone; ///< Wakes `waitForDone()`.
+    std::deque<Job> m_queue; ///< Jobs waiting for a thread.
+    std::vector<std::thread> m_threads; ///< Started workers.
+    int m_maxThreadCount; ///< Upper bound on `m_threads.size()`.
+    size_t m_maxQueueDepth; ///< Upper bound on `m_queue.size()`, `0` for none.
+    int m_idleThreads; ///< Workers waiting for a job.
+    bool m_stopping; ///< Set by the destructor.
+    Stats m_stats; ///< Counters, `queued` and `threadCount` are filled by `stats()`.
+};
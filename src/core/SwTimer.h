@@ -22,7 +22,9 @@
 
 #include "SwObject.h"
 #include "SwCoreApplication.h"
+#include <atomic>
 #include <chrono>
+#include <memory>
 
 /**
  * @class SwTimer
@@ -52,9 +54,9 @@ public:
         : SwObject(parent)
         , m_interval(ms*1000) // interval stocké en microsecondes
         , m_running(false)
-        , m_timerId(-1)
         , m_singleShot(false)
         , m_timerType(TimerType::PreciseTimer)
+        , m_executionHint(ExecutionHint::Fiber)
     {
     }
 
@@ -63,9 +65,6 @@ public:
      */
     virtual ~SwTimer() {
         stop();
-        if (m_timerId != -1) {
-            SwCoreApplication::instance()->removeTimer(m_timerId);
-        }
     }
 
     /**
@@ -104,18 +103,42 @@ public:
 
     /**
      * @brief Starts the timer with the previously set interval.
+     *
+     * The timer is armed on the loop the object lives in (`thread()`), falling back to
+     * `SwCoreApplication::instance()` for an object created outside any loop. From another
+     * thread, the arming is posted to that loop.
      */
     void start() {
         if (!m_running) {
             m_running = true;
-            m_startTime = std::chrono::steady_clock::now();
+            m_startTime = SwClock::now();
 
-            m_timerId = SwCoreApplication::instance()->addTimer([this]() {
+            // Le timer est armé sur sa boucle d'affinité ; stop() l'y retire, même après un moveToThread
+            m_loop = thread() ? thread() : SwCoreApplication::instance();
+            std::shared_ptr<Arming> arming = std::make_shared<Arming>();
+            m_arming = arming;
+            std::function<void()> callback = [this, arming]() {
+                if (!arming->active.load(std::memory_order_acquire)) {
+                    return; // arrêté depuis un autre thread, le retrait est en route
+                }
                 emit timeout();
                  // Pour un timer récurrent, on réinitialise l'heure de départ
-                m_startTime = std::chrono::steady_clock::now();
-            }, static_cast<int>(m_interval), m_singleShot);
-
+                m_startTime = SwClock::now();
+            };
+            int interval = static_cast<int>(m_interval);
+            bool singleShot = m_singleShot;
+            ExecutionHint hint = m_executionHint;
+            if (SwCoreApplication::currentLoop() == m_loop) {
+                arming->timerId = m_loop->addTimer(std::move(callback), interval, singleShot, hint);
+            } else {
+                // Même file que le retrait posté par stop() : l'ordre armement/retrait est conservé
+                SwCoreApplication* loop = m_loop;
+                loop->postEventUnbounded([loop, arming, callback, interval, singleShot, hint]() {
+                    if (arming->active.load(std::memory_order_acquire)) {
+                        arming->timerId = loop->addTimer(callback, interval, singleShot, hint);
+                    }
+                }, ExecutionHint::Inline);
+            }
         }
     }
 
@@ -128,18 +151,24 @@ public:
     }
 
     /**
-     * @brief Stops the timer.
+     * @brief Stops the timer. Safe from any thread.
+     *
+     * From the thread of the loop the timer runs on, the timer is removed at once. From another
+     * thread, the timer is disarmed immediately and its removal is posted to its loop.
      */
     void stop() {
         if (m_running) {
             m_running = false;
-            if (m_timerId != -1) {
-                int currentTimerId = m_timerId;
-                SwCoreApplication::instance()->postEvent([currentTimerId]() {
-                    // programmation d'un event pour arrêter le timer asynchrone
-                    SwCoreApplication::instance()->removeTimer(currentTimerId);
-                });
-                m_timerId = -1;
+            std::shared_ptr<Arming> arming = std::move(m_arming);
+            arming->active.store(false, std::memory_order_release);
+            if (SwCoreApplication::currentLoop() == m_loop) {
+                // retrait en O(1), sûr même depuis le slot connecté à timeout()
+                m_loop->removeTimer(arming->timerId);
+            } else {
+                SwCoreApplication* loop = m_loop;
+                loop->postEventUnbounded([loop, arming]() {
+                    loop->removeTimer(arming->timerId);
+                }, ExecutionHint::Inline);
             }
         }
     }
@@ -160,7 +189,7 @@ public:
         if (!m_running) {
             return -1;
         }
-        auto now = std::chrono::steady_clock::now();
+        auto now = SwClock::now();
         auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(now - m_startTime).count();
         auto remaining_us = m_interval - elapsed_us;
         return remaining_us > 0 ? static_cast<int>(remaining_us / 1000) : 0;
@@ -184,37 +213,112 @@ public:
         return m_timerType;
     }
 
+    /**
+     * @brief Sets where the `timeout` slots run, to be called before `start()`.
+     *
+     * With `ExecutionHint::Inline` the slots run directly on the main context, without the two
+     * fiber switches of a tick. Suited to short, high-rate timers (telemetry, polling). If a slot
+     * yields anyway, the timer silently goes back to fiber execution for its next ticks.
+     *
+     * @param hint The execution hint.
+     */
+    void setExecutionHint(ExecutionHint hint) {
+        if (!m_running) {
+            m_executionHint = hint;
+        }
+    }
+
+    /**
+     * @brief Returns the execution hint requested for the timer.
+     */
+    ExecutionHint executionHint() const {
+        return m_executionHint;
+    }
+
+    /**
+     * @brief Lightweight handle on a timer armed by `singleShot`.
+     *
+     * Copyable and trivially destructible; it only names the timer in its event loop. `cancel()`
+     * is safe from any thread, `isActive()` only answers on the thread of that loop.
+     */
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(SwCoreApplication* app, int timerId)
+            : m_app(app), m_timerId(timerId)
+        {}
+
+        /**
+         * @brief Returns `true` until the callback has been started or the timer cancelled.
+         *
+         * Loop thread only. A timer armed from another thread reads as inactive until its
+         * posted arming has run.
+         */
+        bool isActive() const {
+            return m_app && SwCoreApplication::currentLoop() == m_app && m_app->hasTimer(m_timerId);
+        }
+
+        /**
+         * @brief Cancels the timer if it has not fired yet. Safe from any thread.
+         *
+         * The removal is posted behind the arming when the timer is not registered yet, or when
+         * called from another thread; identifiers are never reused, so a late removal is harmless.
+         */
+        void cancel() {
+            if (m_app) {
+                SwCoreApplication* app = m_app;
+                int timerId = m_timerId;
+                if (SwCoreApplication::currentLoop() == app && app->hasTimer(timerId)) {
+                    app->removeTimer(timerId);
+                } else {
+                    app->postEventUnbounded([app, timerId]() {
+                        app->removeTimer(timerId);
+                    }, ExecutionHint::Inline);
+                }
+                m_app = nullptr;
+            }
+        }
+
+        int timerId() const {
+            return m_timerId;
+        }
+
+    private:
+        SwCoreApplication* m_app = nullptr; ///< Event loop owning the timer.
+        int m_timerId = -1; ///< Identifier of the timer in `m_app`.
+    };
+
     /**
      * @brief Creates a single-shot timer that executes a callback after a specified delay.
      *
+     * The callback is registered directly with the event loop: no `SwTimer` object, signal
+     * connection or `deleteLater` is involved. From a thread without a loop, the timer goes to
+     * the main application and its arming is posted there.
+     *
      * @param ms The delay in milliseconds.
      * @param callback The callback function to execute.
+     * @param hint `ExecutionHint::Inline` for a short callback that never yields.
+     * @return A handle that can cancel the timer; it may be ignored.
      */
-    static void singleShot(int ms, std::function<void()> callback) {
-        SwTimer* tempTimer = new SwTimer(ms);
-
-        tempTimer->setSingleShot(true);
-        tempTimer->connect(tempTimer, SIGNAL(timeout), std::function<void(void)>([callback, tempTimer]() {
-            callback();
-            tempTimer->stop();
-            tempTimer->deleteLater();
-        }));
-
-        tempTimer->start();
+    static Handle singleShot(int ms, std::function<void()> callback, ExecutionHint hint = ExecutionHint::Fiber) {
+        SwCoreApplication* app = SwCoreApplication::instance();
+        if (SwCoreApplication::currentLoop() == app) {
+            return Handle(app, app->addTimer(std::move(callback), ms * 1000, true, hint));
+        }
+        // L'identifiant est réservé ici pour que le handle soit utilisable tout de suite
+        int timerId = app->reserveTimerId();
+        int interval = ms * 1000;
+        app->postEventUnbounded([app, timerId, callback, interval, hint]() {
+            app->registerTimer(timerId, callback, interval, true, hint);
+        }, ExecutionHint::Inline);
+        return Handle(app, timerId);
     }
 
     template <typename T>
-    static void singleShot(int ms, T* obj, void (T::*func)()) {
-        SwTimer* tempTimer = new SwTimer(ms);
-
-        tempTimer->setSingleShot(true);
-        tempTimer->connect(tempTimer, SIGNAL(timeout), [obj, func, tempTimer]() {
+    static Handle singleShot(int ms, T* obj, void (T::*func)()) {
+        return singleShot(ms, [obj, func]() {
             (obj->*func)();
-            tempTimer->stop();
-            tempTimer->deleteLater();
         });
-
-        tempTimer->start();
     }
 signals:
     /**
@@ -223,11 +327,21 @@ signals:
     DECLARE_SIGNAL(timeout)
 
 private:
+    /**
+     * @brief State shared between the timer and its callback, which may outlive it by one post.
+     */
+    struct Arming {
+        std::atomic<bool> active{true}; ///< Cleared by `stop()`; a disarmed callback does nothing.
+        int timerId = -1; ///< Identifier of the timer in its loop, only used on that loop's thread.
+    };
+
     long long m_interval;  ///< The interval in microseconds for the timer.
+    SwCoreApplication* m_loop = nullptr; ///< Loop the running timer is registered on.
     bool m_running;        ///< Indicates if the timer is currently running.
-    int m_timerId;         ///< The unique identifier for the timer in the SwCoreApplication instance.
+    std::shared_ptr<Arming> m_arming; ///< Arming of the running timer, `nullptr` when stopped.
     bool m_singleShot;     ///< Indicates if the timer is single-shot.
     TimerType m_timerType; ///< The type of the timer.
+    ExecutionHint m_executionHint; ///< Whether `timeout` is emitted in a fiber or inline.
     std::chrono::steady_clock::time_point m_startTime; ///< Keeps track of when the timer started.
 };
 
@@ -0,0 +1,168 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+
+/**
+ * @class SwTimerHeap
+ * @brief 4-ary min-heap of timer deadlines used by `SwCoreApplication`.
+ *
+ * Each entry references a timer by identifier and carries the absolute deadline at which it must
+ * fire. The event loop only looks at the top of the heap, so finding the next due timer is O(1)
+ * and popping or pushing one is O(log4 n), whatever the number of armed timers.
+ *
+ * ### Lazy cancellation:
+ * Stopping a timer does not search the heap. The owner simply forgets the timer (or bumps its
+ * schedule order) and the stale entry is discarded when it reaches the top. `compact()` rebuilds
+ * the heap in O(n) when stale entries outnumber live ones.
+ *
+ * ### Ordering:
+ * Entries with the same deadline pop in scheduling order (`order` is a monotonic counter), which
+ * keeps timer firing order deterministic.
+ *
+ * ### Sleepers:
+ * An entry may also carry a suspended fiber (`sleeper`) instead of a timer, which lets
+ * `SwCoreApplication::sleepFiberUntil` park a fiber on the heap without allocating a timer.
+ */
+class SwTimerHeap {
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    /**
+     * @brief A scheduled deadline.
+     */
+    struct Entry {
+        TimePoint deadline; ///< Absolute time at which the timer fires.
+        uint64_t order;     ///< Scheduling order, also used to detect stale entries.
+        int timerId;        ///< Identifier of the timer in `SwCoreApplication`, `SleeperId` for a sleeper.
+        void* sleeper;      ///< Fiber to resume at `deadline` when `timerId == SleeperId`, else `nullptr`.
+    };
+
+    static const int SleeperId = -1; ///< `timerId` of the entries that carry a sleeping fiber.
+
+    bool isEmpty() const {
+        return m_entries.empty();
+    }
+
+    size_t size() const {
+        return m_entries.size();
+    }
+
+    void reserve(size_t capacity) {
+        m_entries.reserve(capacity);
+    }
+
+    void clear() {
+        m_entries.clear();
+    }
+
+    /**
+     * @brief Returns the entry with the earliest deadline. The heap must not be empty.
+     */
+    const Entry& top() const {
+        return m_entries.front();
+    }
+
+    void push(const Entry& entry) {
+        m_entries.push_back(entry);
+        siftUp(m_entries.size() - 1);
+    }
+
+    void pop() {
+        m_entries.front() = m_entries.back();
+        m_entries.pop_back();
+        if (!m_entries.empty()) {
+            siftDown(0);
+        }
+    }
+
+    /**
+     * @brief Removes every entry for which `isStale` returns `true`, then restores the heap order.
+     */
+    template<typename Predicate>
+    void compact(Predicate isStale) {
+        size_t kept = 0;
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            if (!isStale(m_entries[i])) {
+                m_entries[kept++] = m_entries[i];
+            }
+        }
+        m_entries.resize(kept);
+        if (kept > 1) {
+            for (size_t i = (kept - 2) / Arity + 1; i-- > 0; ) {
+                siftDown(i);
+            }
+        }
+    }
+
+private:
+    static const size_t Arity = 4;
+
+    static bool before(const Entry& a, const Entry& b) {
+        return a.deadline < b.deadline || (a.deadline == b.deadline && a.order < b.order);
+    }
+
+    void siftUp(size_t index) {
+        Entry moving = m_entries[index];
+        while (index > 0) {
+            size_t parent = (index - 1) / Arity;
+            if (!before(moving, m_entries[parent])) {
+                break;
+            }
+            m_entries[index] = m_entries[parent];
+            index = parent;
+        }
+        m_entries[index] = moving;
+    }
+
+    void siftDown(size_t index) {
+        const size_t count = m_entries.size();
+        Entry moving = m_entries[index];
+        while (true) {
+            size_t first = index * Arity + 1;
+            if (first >= count) {
+                break;
+            }
+            size_t last = (std::min)(first + Arity, count);
+            size_t best = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (before(m_entries[child], m_entries[best])) {
+                    best = child;
+                }
+            }
+            if (!before(m_entries[best], moving)) {
+                break;
+            }
+            m_entries[index] = m_entries[best];
+            index = best;
+        }
+        m_entries[index] = moving;
+    }
+
+    std::vector<Entry> m_entries;
+};
@@ -0,0 +1,112 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <iostream>
+#include <mutex>
+#include "SwFiberWaiter.h"
+
+
+/**
+ * @class SwWaitGroup
+ * @brief Waits for a set of fibers or tasks to finish, parking only the waiting fiber.
+ *
+ * `add()` the number of tasks before starting them, have each call `done()` when it finishes, and
+ * `wait()` parks until the counter drops to zero. Every waiter is then resumed, in the order it
+ * started waiting.
+ *
+ * ### Example:
+ * ```cpp
+ * SwWaitGroup group;
+ * group.add(files.size());
+ * for (const SwString& path : files) {
+ *     app.postEvent([&group, path]() { index(path); group.done(); });
+ * }
+ * group.wait();
+ * ```
+ */
+class SwWaitGroup {
+public:
+    SwWaitGroup()
+        : m_count(0)
+    {}
+
+    SwWaitGroup(const SwWaitGroup&) = delete;
+    SwWaitGroup& operator=(const SwWaitGroup&) = delete;
+
+    /**
+     * @brief Adds `delta` (possibly negative) to the counter and resumes the waiters when it reaches zero.
+     */
+    void add(int delta = 1) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_count += delta;
+        if (m_count < 0) {
+            std::cerr << "SwWaitGroup: done() called more times than add()" << std::endl;
+            m_count = 0;
+        }
+        if (m_count == 0) {
+            while (SwFiberWaitNode* next = m_waiters.pop()) {
+                m_stats.resumed(*next);
+                next->waiter->wake();
+            }
+        }
+    }
+
+    void done() {
+        add(-1);
+    }
+
+    /**
+     * @brief Returns once the counter is zero.
+     */
+    void wait() {
+        SwFiberWaiter waiter;
+        SwFiberWaitNode node;
+        node.waiter = &waiter;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            ++m_stats.acquisitions;
+            if (m_count == 0) {
+                return;
+            }
+            waiter.prepare();
+            m_waiters.push(&node);
+            m_stats.enqueued(node);
+        }
+        waiter.wait();
+    }
+
+    int count() const {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_count;
+    }
+
+    SwFiberSyncStats stats() const {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_stats;
+    }
+
+private:
+    int m_count; ///< Tasks still running.
+    mutable std::mutex m_mutex; ///< Protects the counter and the wait list.
+    SwFiberWaitList m_waiters; ///< Waiting for the counter to reach zero.
+    SwFiberSyncStats m_stats;
+};
@@ -0,0 +1,181 @@
+#pragma once
+/***************************************************************************************************
+ * This file is part of a project developed by Ariya Consulting and Eymeric O'Neill.
+ *
+ * Copyright (C) [year] Ariya Consulting
+ * Author/Creator: Eymeric O'Neill
+ * Contact: +33 6 52 83 83 31
+ * Email: eymeric.oneill@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ***************************************************************************************************/
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+/**
+ * @class SwWorkStealingDeque
+ * @brief Chase-Lev work-stealing deque of pointers.
+ *
+ * The owner thread pushes and pops at the bottom (LIFO, cache friendly); any other thread may
+ * steal from the top (FIFO). Only steals and the pop of the last element contend, on a single CAS.
+ * The ring buffer grows when full; old buffers are kept until destruction because a concurrent
+ * thief may still be reading them.
+ *
+ * Memory orderings follow Lê, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing
+ * for Weak Memory Models" (PPoPP 2013).
+ *
+ * @tparam T Element type; the deque stores `T*` and never owns the pointees.
+ */
+template<typename T>
+class SwWorkStealingDeque {
+public:
+    explicit SwWorkStealingDeque(size_t initialCapacity = 256)
+        : m_top(0),
+          m_bottom(0)
+    {
+        size_t capacity = 1;
+        while (capacity < initialCapacity) {
+            capacity <<= 1;
+        }
+        Buffer* buffer = new Buffer(capacity);
+        m_buffers.push_back(buffer);
+        m_buffer.store(buffer, std::memory_order_relaxed);
+    }
+
+    ~SwWorkStealingDeque() {
+        for (Buffer* buffer : m_buffers) {
+            delete buffer;
+        }
+    }
+
+    SwWorkStealingDeque(const SwWorkStealingDeque&) = delete;
+    SwWorkStealingDeque& operator=(const SwWorkStealingDeque&) = delete;
+
+    /**
+     * @brief Pushes an element at the bottom. Owner thread only.
+     */
+    void push(T* item) {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t top = m_top.load(std::memory_order_acquire);
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<int64_t>(buffer->capacity) - 1) {
+            buffer = grow(buffer, bottom, top);
+        }
+        buffer->put(bottom, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Pops the most recently pushed element. Owner thread only.
+     * @return The element, or `nullptr` if the deque is empty (or a thief took the last one).
+     */
+    T* pop() {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        T* item = nullptr;
+        if (top <= bottom) {
+            item = buffer->get(bottom);
+            if (top == bottom) {
+                // Dernier élément : course possible avec un voleur
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    item = nullptr;
+                }
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+        } else {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /**
+     * @brief Steals the oldest element. Safe from any thread.
+     * @return The element, or `nullptr` if the deque is empty or another thread won the race.
+     */
+    T* steal() {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        Buffer* buffer = m_buffer.load(std::memory_order_acquire);
+        T* item = buffer->get(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    /**
+     * @brief Returns an estimate of the number of elements.
+     */
+    size_t sizeHint() const {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+    bool isEmpty() const {
+        return sizeHint() == 0;
+    }
+
+private:
+    struct Buffer {
+        explicit Buffer(size_t size)
+            : capacity(size),
+              mask(size - 1),
+              slots(new std::atomic<T*>[size])
+        {}
+
+        ~Buffer() {
+            delete[] slots;
+        }
+
+        T* get(int64_t index) const {
+            return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t index, T* item) {
+            slots[static_cast<size_t>(index) & mask].store(item, std::memory_order_relaxed);
+        }
+
+        size_t capacity;
+        size_t mask;
+        std::atomic<T*>* slots;
+    };
+
+    Buffer* grow(Buffer* old, int64_t bottom, int64_t top) {
+        Buffer* buffer = new Buffer(old->capacity * 2);
+        for (int64_t i = top; i < bottom; ++i) {
+            buffer->put(i, old->get(i));
+        }
+        m_buffers.push_back(buffer);
+        m_buffer.store(buffer, std::memory_order_release);
+        return buffer;
+    }
+
+    std::atomic<int64_t> m_top; ///< Index of the oldest element, advanced by thieves and the last pop.
+    std::atomic<int64_t> m_bottom; ///< Index one past the newest element, owned by the owner thread.
+    std::atomic<Buffer*> m_buffer; ///< Current ring buffer.
+    std::vector<Buffer*> m_buffers; ///< Every buffer ever allocated, freed at destruction.
+};